@@ -26,21 +26,50 @@
 #include <yarp/os/Network.h>
 #include <yarp/os/Time.h>
 #include <yarp/os/Property.h>
+#include <yarp/os/Bottle.h>
+#include <yarp/dev/PolyDriver.h>
+#include <yarp/os/Stamp.h>
+#include <math.h>
+#include <string.h>
+#include <algorithm>
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+#if !defined(_WIN32)
+#include <sys/resource.h>
+#endif
 
 #include "CameraTest.h"
 
 using namespace robottestingframework;
 using namespace yarp::os;
 using namespace yarp::sig;
+using namespace yarp::dev;
 
 #define TIMES       1
 #define FREQUENCY   30
 #define TOLERANCE   5
+#define PIPELINE_DRAIN_TIME 1.0  // s, for the frames in flight at the end
 
 
 // prepare the plugin
 ROBOTTESTINGFRAMEWORK_PREPARE_PLUGIN(CameraTest)
 
+/**
+ * The CPU time (user + system) used so far by the process, in seconds.
+ */
+static double processCpuTime() {
+#if !defined(_WIN32)
+    struct rusage usage;
+    if(getrusage(RUSAGE_SELF, &usage) != 0)
+        return 0.0;
+    return usage.ru_utime.tv_sec + usage.ru_stime.tv_sec +
+           (usage.ru_utime.tv_usec + usage.ru_stime.tv_usec)*1e-6;
+#else
+    return 0.0;
+#endif
+}
+
 CameraTest::CameraTest() : yarp::robottestingframework::TestCase("CameraTest") {
 }
 
@@ -52,14 +81,87 @@ bool CameraTest::setup(yarp::os::Property& property) {
         setName(property.find("name").asString());
 
     // updating parameters
-    ROBOTTESTINGFRAMEWORK_ASSERT_ERROR_IF_FALSE(property.check("portname"),
-                        "The portname must be given as the test paramter!");
-    cameraPortName = property.find("portname").asString();
     measure_time = property.check("measure_time") ? property.find("measure_time").asInt32() : TIMES;
     expected_frequency = property.check("expected_frequency") ? property.find("expected_frequency").asInt32() : FREQUENCY;
     tolerance = property.check("tolerance") ? property.find("tolerance").asInt32() : TOLERANCE;
+    rateWindow = property.check("rate_window") ? property.find("rate_window").asFloat64() : 1.0;
+    maxIntervalP99 = property.check("max_interval_p99") ? property.find("max_interval_p99").asFloat64() : -1;
+    toleratedDroppedFrames = property.check("tolerated_dropped_frames") ? property.find("tolerated_dropped_frames").asInt32() : -1;
+    contentChecks = property.check("content_checks") ? property.find("content_checks").asBool() : false;
+    toleratedBadFrames = property.check("tolerated_bad_frames") ? property.find("tolerated_bad_frames").asInt32() : 0;
+    port.setContentChecks(contentChecks);
+    port.getContent().configure(property.check("black_level") ? property.find("black_level").asFloat64() : 16,
+                                property.check("saturation_level") ? property.find("saturation_level").asFloat64() : 240,
+                                property.check("min_std") ? property.find("min_std").asFloat64() : 4);
+    maxPipelineLatencyP99 = property.check("max_pipeline_latency_p99") ? property.find("max_pipeline_latency_p99").asFloat64() : -1;
+
+    maxSkewP99 = property.check("max_skew_p99") ? property.find("max_skew_p99").asFloat64() : -1;
+    maxUnpairedFrames = property.check("max_unpaired_frames") ? property.find("max_unpaired_frames").asInt32() : -1;
+    maxSkewDrift = property.check("max_skew_drift") ? property.find("max_skew_drift").asFloat64() : -1;
+
+    benchmark = property.check("benchmark") ? property.find("benchmark").asBool() : false;
+    if(benchmark) {
+        Bottle* btresolutions = property.find("resolutions").asList();
+        resolutions.fromString(btresolutions ? btresolutions->toString() : "(320 240) (640 480)");
+        Bottle* btformats = property.find("formats").asList();
+        formats.fromString(btformats ? btformats->toString() :
+                           (property.check("formats") ? property.find("formats").asString() : "rgb"));
+        port.setWindow(rateWindow);
+        port.setStrict();
+        ROBOTTESTINGFRAMEWORK_ASSERT_ERROR_IF_FALSE(port.open("/CameraTest/image:i"),
+                            "opening port, is YARP network available?");
+        return true;
+    }
+
+    if(property.check("stereo")) {
+        Bottle* btcameras = property.find("stereo").asList();
+        ROBOTTESTINGFRAMEWORK_ASSERT_ERROR_IF_FALSE(btcameras && btcameras->size() == 2,
+                            "The stereo parameter must be the list of the left and of the right camera ports");
+        const char* sides[2] = {"left", "right"};
+        for(int i=0; i<2; i++) {
+            stereoPortNames.push_back(btcameras->get(i).asString());
+            stereo[i].setWindow(rateWindow);
+            stereo[i].setStrict();
+            // twice the expected frames, so that nothing is allocated while reading
+            stereo[i].reserve(2*(measure_time+1)*expected_frequency);
+            ROBOTTESTINGFRAMEWORK_ASSERT_ERROR_IF_FALSE(stereo[i].open(Asserter::format("/CameraTest/stereo/%s:i", sides[i])),
+                                "opening port, is YARP network available?");
+            ROBOTTESTINGFRAMEWORK_TEST_REPORT(Asserter::format("connecting from %s to %s",
+                                               stereoPortNames[i].c_str(), stereo[i].getName().c_str()));
+            ROBOTTESTINGFRAMEWORK_ASSERT_ERROR_IF_FALSE(Network::connect(stereoPortNames[i], stereo[i].getName()),
+                                Asserter::format("could not connect to %s", stereoPortNames[i].c_str()));
+        }
+        return true;
+    }
+
+    if(property.check("pipeline")) {
+        Bottle* btstages = property.find("pipeline").asList();
+        ROBOTTESTINGFRAMEWORK_ASSERT_ERROR_IF_FALSE(btstages && btstages->size() >= 2,
+                            "The pipeline must be a list of at least two ports");
+        for(size_t i=0; i<btstages->size(); i++)
+            pipelinePortNames.push_back(btstages->get(i).asString());
+        matcher.setStages(pipelinePortNames.size());
+        for(size_t i=0; i<pipelinePortNames.size(); i++) {
+            PipelineStage* stage = new PipelineStage(matcher, i);
+            stages.push_back(stage);
+            stage->setStrict();
+            ROBOTTESTINGFRAMEWORK_ASSERT_ERROR_IF_FALSE(stage->open(Asserter::format("/CameraTest/pipeline/%d:i", (int)i)),
+                                "opening port, is YARP network available?");
+            ROBOTTESTINGFRAMEWORK_TEST_REPORT(Asserter::format("connecting from %s to %s",
+                                               pipelinePortNames[i].c_str(), stage->getName().c_str()));
+            ROBOTTESTINGFRAMEWORK_ASSERT_ERROR_IF_FALSE(Network::connect(pipelinePortNames[i], stage->getName()),
+                                Asserter::format("could not connect to %s", pipelinePortNames[i].c_str()));
+        }
+        return true;
+    }
+
+    ROBOTTESTINGFRAMEWORK_ASSERT_ERROR_IF_FALSE(property.check("portname"),
+                        "The portname must be given as the test paramter!");
+    cameraPortName = property.find("portname").asString();
 
     // opening port
+    port.setWindow(rateWindow);
+    port.setStrict();
     ROBOTTESTINGFRAMEWORK_ASSERT_ERROR_IF_FALSE(port.open("/CameraTest/image:i"),
                         "opening port, is YARP network available?");
 
@@ -75,28 +177,599 @@ bool CameraTest::setup(yarp::os::Property& property) {
 }
 
 void CameraTest::tearDown() {
-    Network::disconnect(cameraPortName, port.getName());
+    for(size_t i=0; i<stages.size(); i++) {
+        Network::disconnect(pipelinePortNames[i], stages[i]->getName());
+        stages[i]->close();
+        delete stages[i];
+    }
+    stages.clear();
+    for(size_t i=0; i<stereoPortNames.size(); i++) {
+        Network::disconnect(stereoPortNames[i], stereo[i].getName());
+        stereo[i].close();
+    }
+    if(!cameraPortName.empty())
+        Network::disconnect(cameraPortName, port.getName());
     port.close();
 }
 
 void CameraTest::run() {
-    ROBOTTESTINGFRAMEWORK_TEST_REPORT("Reading images...");
-    double timeStart=yarp::os::Time::now();
-    double timeNow=timeStart;
-
-    int frames=0;
-    while(timeNow<timeStart+measure_time) {
-        Image *image=port.read(false);
-        if(image!=0)
-            frames++;
-        yarp::os::Time::delay(0.01);
-        timeNow=yarp::os::Time::now();
+    if(!stages.empty()) {
+        runPipeline();
+        return;
+    }
+    if(!stereoPortNames.empty()) {
+        runStereo();
+        return;
     }
+    if(benchmark) {
+        runBenchmark();
+        return;
+    }
+
+    ROBOTTESTINGFRAMEWORK_TEST_REPORT("Reading images...");
+    // drop the frames queued since the connection
+    while(port.getPendingReads() > 0)
+        port.read(false);
+    port.reset();
+    double cpu = processCpuTime();
+    port.useCallback();
+    yarp::os::Time::delay(measure_time);
+    port.disableCallback();
+    reportThroughput(cameraPortName, measure_time, processCpuTime() - cpu);
 
+    int frames = port.getFrames();
     int expectedFrames = measure_time*expected_frequency;
     ROBOTTESTINGFRAMEWORK_TEST_REPORT(Asserter::format("Received %d frames, expecting %d",
                                        frames,
                                        expectedFrames));
     ROBOTTESTINGFRAMEWORK_TEST_FAIL_IF_FALSE(abs(frames-expectedFrames)<tolerance,
                      "checking number of received frames");
+    if(frames < 2)
+        return;
+
+    const Histogram& intervals = port.getIntervals();
+    ROBOTTESTINGFRAMEWORK_TEST_REPORT(Asserter::format("Inter-frame interval (s): p50 %.4f, p90 %.4f, p99 %.4f, p99.9 %.4f (min: %.4f, max: %.4f)",
+                                       intervals.getPercentile(50), intervals.getPercentile(90),
+                                       intervals.getPercentile(99), intervals.getPercentile(99.9),
+                                       intervals.getMin(), intervals.getMax()));
+    if(maxIntervalP99 > 0)
+        ROBOTTESTINGFRAMEWORK_TEST_FAIL_IF_FALSE(intervals.getPercentile(99) <= maxIntervalP99,
+                         Asserter::format("99th percentile of the inter-frame interval is higher than %.4f s", maxIntervalP99));
+
+    if(port.getWindows() > 0)
+        ROBOTTESTINGFRAMEWORK_TEST_REPORT(Asserter::format("Frame rate over %lu windows of %.2f s: mean %.2f fps, std %.2f (min: %.2f, max: %.2f)",
+                                           port.getWindows(), rateWindow, port.getMeanRate(),
+                                           port.getRateStdDev(), port.getMinRate(), port.getMaxRate()));
+
+    if(port.hasTimeStamp()) {
+        const Histogram& sender = port.getSenderIntervals();
+        const SequenceAnalyzer& seq = port.getSequence();
+        ROBOTTESTINGFRAMEWORK_TEST_REPORT(Asserter::format("Sender inter-frame interval (s): p50 %.4f, p99 %.4f (max: %.4f)",
+                                           sender.getPercentile(50), sender.getPercentile(99), sender.getMax()));
+        ROBOTTESTINGFRAMEWORK_TEST_REPORT(Asserter::format("Dropped frames %lu (bursts: %s), repeated %lu, reordered %lu",
+                                           seq.getLost(), seq.burstsToString().c_str(),
+                                           seq.getRepeated(), seq.getReordered()));
+        if(toleratedDroppedFrames >= 0)
+            ROBOTTESTINGFRAMEWORK_TEST_FAIL_IF_FALSE(seq.getLost() <= (unsigned long)toleratedDroppedFrames,
+                             Asserter::format("More than %d frames dropped", toleratedDroppedFrames));
+    }
+    else {
+        ROBOTTESTINGFRAMEWORK_TEST_REPORT("The frames have no time stamp: dropped frames cannot be estimated");
+    }
+
+    if(contentChecks) {
+        FrameContent& content = port.getContent();
+        unsigned long bad = content.getRepeated() + content.getBlack() +
+                            content.getSaturated() + content.getTorn();
+        ROBOTTESTINGFRAMEWORK_TEST_REPORT(Asserter::format("Checked %lu frames: %lu repeated (longest run: %lu), %lu black, %lu saturated, %lu torn",
+                                           content.getChecked(), content.getRepeated(), content.getMaxRepeatedRun(),
+                                           content.getBlack(), content.getSaturated(), content.getTorn()));
+        ROBOTTESTINGFRAMEWORK_TEST_FAIL_IF_FALSE(bad <= (unsigned long)toleratedBadFrames,
+                         Asserter::format("%lu bad frames, tolerated %d", bad, toleratedBadFrames));
+    }
+}
+
+void CameraTest::reportThroughput(const std::string& label, double duration, double cpu) {
+    const Histogram& latencies = port.getLatencies();
+    std::string latency = (latencies.getCount() > 0) ?
+                Asserter::format("latency p50 %.4f s, p99 %.4f s", latencies.getPercentile(50), latencies.getPercentile(99)) :
+                std::string("latency n/a");
+    ROBOTTESTINGFRAMEWORK_TEST_REPORT(Asserter::format("%s: %.2f fps, %.2f MB/s, %s, CPU %.1f%%",
+                                       label.c_str(), port.getFrames()/duration,
+                                       port.getBytes()/duration/1e6, latency.c_str(),
+                                       100.0*cpu/duration));
+}
+
+void CameraTest::runBenchmark() {
+    const double baselineTime = 1.0;
+    for(size_t f=0; f<formats.size(); f++) {
+        std::string format = formats.get(f).asString();
+        for(size_t r=0; r<resolutions.size(); r++) {
+            Bottle* resolution = resolutions.get(r).asList();
+            if(!resolution || resolution->size() != 2) {
+                ROBOTTESTINGFRAMEWORK_TEST_CHECK(false, "the resolutions must be lists of width and height");
+                continue;
+            }
+            int width = resolution->get(0).asInt32();
+            int height = resolution->get(1).asInt32();
+            std::string label = Asserter::format("%dx%d %s", width, height, format.c_str());
+
+            Property options;
+            options.put("device", "grabberDual");
+            options.put("subdevice", "fakeFrameGrabber");
+            options.put("name", "/CameraTest/benchmark/grabber");
+            options.put("width", width);
+            options.put("height", height);
+            options.put("freq", (double)expected_frequency);
+            if(format == "mono" || format == "bayer")
+                options.put(format, 1);
+            PolyDriver grabber;
+            if(!grabber.open(options)) {
+                ROBOTTESTINGFRAMEWORK_TEST_CHECK(false, Asserter::format("opening the fakeFrameGrabber for %s", label.c_str()));
+                continue;
+            }
+
+            // the CPU of the grabber alone, subtracted from the one measured while reading
+            double cpu = processCpuTime();
+            yarp::os::Time::delay(baselineTime);
+            double baseline = (processCpuTime() - cpu)/baselineTime;
+
+            if(!Network::connect("/CameraTest/benchmark/grabber", port.getName())) {
+                ROBOTTESTINGFRAMEWORK_TEST_CHECK(false, Asserter::format("connecting to the fakeFrameGrabber for %s", label.c_str()));
+                grabber.close();
+                continue;
+            }
+            while(port.getPendingReads() > 0)
+                port.read(false);
+            port.reset();
+            cpu = processCpuTime();
+            port.useCallback();
+            yarp::os::Time::delay(measure_time);
+            port.disableCallback();
+            cpu = processCpuTime() - cpu - baseline*measure_time;
+            Network::disconnect("/CameraTest/benchmark/grabber", port.getName());
+            grabber.close();
+
+            reportThroughput(label, measure_time, (cpu > 0.0) ? cpu : 0.0);
+            ROBOTTESTINGFRAMEWORK_TEST_CHECK(port.getFrames() > 0,
+                             Asserter::format("frames received for %s", label.c_str()));
+        }
+    }
+}
+
+void CameraTest::runPipeline() {
+    ROBOTTESTINGFRAMEWORK_TEST_REPORT(Asserter::format("Reading the frames of %d stages for %d seconds...",
+                                       (int)stages.size(), measure_time));
+    for(size_t i=0; i<stages.size(); i++) {
+        while(stages[i]->getPendingReads() > 0)
+            stages[i]->read(false);
+    }
+    matcher.reset();
+    for(size_t i=0; i<stages.size(); i++)
+        stages[i]->useCallback();
+    yarp::os::Time::delay(measure_time);
+    // no new frames are followed, while the ones in flight get through
+    // the stages: those still pending afterwards are lost
+    matcher.drain();
+    yarp::os::Time::delay(PIPELINE_DRAIN_TIME);
+    for(size_t i=0; i<stages.size(); i++)
+        stages[i]->disableCallback();
+    matcher.finish();
+
+    const Histogram& source = matcher.getSourceLatency();
+    if(source.getCount() > 0)
+        ROBOTTESTINGFRAMEWORK_TEST_REPORT(Asserter::format("%s: %lu frames, latency from the stamp (s): p50 %.4f, p99 %.4f (max: %.4f)",
+                                           pipelinePortNames[0].c_str(), source.getCount(),
+                                           source.getPercentile(50), source.getPercentile(99), source.getMax()));
+    else
+        ROBOTTESTINGFRAMEWORK_TEST_REPORT(Asserter::format("%s: no stamped frames received", pipelinePortNames[0].c_str()));
+
+    for(size_t i=1; i<stages.size(); i++) {
+        const Histogram& hop = matcher.getHop(i);
+        const Histogram& cumulative = matcher.getCumulative(i);
+        ROBOTTESTINGFRAMEWORK_TEST_REPORT(Asserter::format("%s: %lu frames matched, %lu missing, %lu unmatched",
+                                           pipelinePortNames[i].c_str(), matcher.getMatched(i),
+                                           matcher.getMissing(i), matcher.getUnmatched(i)));
+        ROBOTTESTINGFRAMEWORK_TEST_CHECK(matcher.getMatched(i) > 0,
+                         Asserter::format("frames of %s matched with %s (is the envelope forwarded?)",
+                                          pipelinePortNames[i].c_str(), pipelinePortNames[0].c_str()));
+        if(hop.getCount() > 0)
+            ROBOTTESTINGFRAMEWORK_TEST_REPORT(Asserter::format("    hop latency (s): p50 %.4f, p90 %.4f, p99 %.4f (max: %.4f)",
+                                               hop.getPercentile(50), hop.getPercentile(90),
+                                               hop.getPercentile(99), hop.getMax()));
+        if(cumulative.getCount() > 0)
+            ROBOTTESTINGFRAMEWORK_TEST_REPORT(Asserter::format("    cumulative latency (s): p50 %.4f, p90 %.4f, p99 %.4f (max: %.4f)",
+                                               cumulative.getPercentile(50), cumulative.getPercentile(90),
+                                               cumulative.getPercentile(99), cumulative.getMax()));
+    }
+
+    const Histogram& total = matcher.getCumulative(stages.size()-1);
+    if(maxPipelineLatencyP99 > 0 && total.getCount() > 0)
+        ROBOTTESTINGFRAMEWORK_TEST_FAIL_IF_FALSE(total.getPercentile(99) <= maxPipelineLatencyP99,
+                         Asserter::format("99th percentile of the pipeline latency is higher than %.4f s", maxPipelineLatencyP99));
+}
+
+void CameraTest::runStereo() {
+    ROBOTTESTINGFRAMEWORK_TEST_REPORT(Asserter::format("Reading the left and right cameras for %d seconds...", measure_time));
+    for(int i=0; i<2; i++) {
+        while(stereo[i].getPendingReads() > 0)
+            stereo[i].read(false);
+        stereo[i].reset();
+        stereo[i].clear();
+    }
+    stereo[0].useCallback();
+    stereo[1].useCallback();
+    yarp::os::Time::delay(measure_time);
+    stereo[0].disableCallback();
+    stereo[1].disableCallback();
+
+    const std::vector<StereoProbe::Frame>& left = stereo[0].getFrameTimes();
+    const std::vector<StereoProbe::Frame>& right = stereo[1].getFrameTimes();
+    for(int i=0; i<2; i++)
+        ROBOTTESTINGFRAMEWORK_TEST_REPORT(Asserter::format("%s: %lu frames, %lu dropped, mean rate %.2f fps",
+                                           stereoPortNames[i].c_str(), stereo[i].getFrames(),
+                                           stereo[i].getSequence().getLost(), stereo[i].getMeanRate()));
+    ROBOTTESTINGFRAMEWORK_TEST_FAIL_IF_FALSE(left.size() > 0 && right.size() > 0,
+                     "no frames received from one of the cameras");
+    if(left.empty() || right.empty())
+        return;
+
+    // both the cameras must stamp their frames, or the arrival times are used
+    bool stamped = stereo[0].hasTimeStamp() && stereo[1].hasTimeStamp();
+    if(!stamped)
+        ROBOTTESTINGFRAMEWORK_TEST_REPORT("The frames have no time stamp: the skew is computed on the arrival times");
+
+    // pairs the frames which are the nearest to each other, from both sides;
+    // the frames of each camera are in the order of their time stamps
+    double maxPairing = 0.5/expected_frequency;
+    Histogram skews;
+    double skewSum = 0.0;
+    double st = 0.0, ss = 0.0, stt = 0.0, sts = 0.0;   // least squares of the skew over time
+    unsigned long pairs = 0;
+    size_t j = 0;
+    for(size_t i=0; i<left.size(); i++) {
+        double tl = left[i].time(stamped);
+        while(j+1 < right.size() && fabs(right[j+1].time(stamped) - tl) <= fabs(right[j].time(stamped) - tl))
+            j++;
+        double tr = right[j].time(stamped);
+        // the left frame must also be the nearest one to the right frame
+        if(i > 0 && fabs(left[i-1].time(stamped) - tr) < fabs(tl - tr))
+            continue;
+        if(i+1 < left.size() && fabs(left[i+1].time(stamped) - tr) < fabs(tl - tr))
+            continue;
+        double skew = tl - tr;
+        if(fabs(skew) > maxPairing)
+            continue;
+        skews.add(fabs(skew));
+        skewSum += skew;
+        double t = tl - left[0].time(stamped);
+        st += t;
+        ss += skew;
+        stt += t*t;
+        sts += t*skew;
+        pairs++;
+    }
+
+    unsigned long unpaired = (left.size() - pairs) + (right.size() - pairs);
+    ROBOTTESTINGFRAMEWORK_TEST_REPORT(Asserter::format("%lu pairs, %lu unpaired frames (%lu left, %lu right)",
+                                       pairs, unpaired,
+                                       (unsigned long)(left.size() - pairs), (unsigned long)(right.size() - pairs)));
+    if(maxUnpairedFrames >= 0)
+        ROBOTTESTINGFRAMEWORK_TEST_FAIL_IF_FALSE(unpaired <= (unsigned long)maxUnpairedFrames,
+                         Asserter::format("More than %d unpaired frames", maxUnpairedFrames));
+    if(pairs == 0)
+        return;
+
+    ROBOTTESTINGFRAMEWORK_TEST_REPORT(Asserter::format("Left/right skew (s): mean %.5f, |skew| p50 %.5f, p90 %.5f, p99 %.5f (max: %.5f)",
+                                       skewSum/pairs, skews.getPercentile(50), skews.getPercentile(90),
+                                       skews.getPercentile(99), skews.getMax()));
+    if(maxSkewP99 > 0)
+        ROBOTTESTINGFRAMEWORK_TEST_FAIL_IF_FALSE(skews.getPercentile(99) <= maxSkewP99,
+                         Asserter::format("99th percentile of the skew is higher than %.5f s", maxSkewP99));
+
+    double den = pairs*stt - st*st;
+    if(pairs > 2 && den > 0.0) {
+        double drift = (pairs*sts - st*ss)/den;
+        ROBOTTESTINGFRAMEWORK_TEST_REPORT(Asserter::format("Drift of the skew: %.3g s/s (%.3f ms over the test)",
+                                           drift, drift*(left.back().time(stamped) - left[0].time(stamped))*1000.0));
+        if(maxSkewDrift > 0)
+            ROBOTTESTINGFRAMEWORK_TEST_FAIL_IF_FALSE(fabs(drift) <= maxSkewDrift,
+                             Asserter::format("The skew drifts faster than %.3g s/s", maxSkewDrift));
+    }
+}
+
+void FrameProbe::reset() {
+    content.reset();
+    frames = stamped = 0;
+    bytes = 0;
+    tprev = stprev = 0.0;
+    intervals.reset();
+    latencies.reset();
+    senderIntervals.reset();
+    sequence.reset();
+    windowStart = -1.0;
+    windowFrames = windows = 0;
+    minRate = maxRate = rateSum = rateSqSum = 0.0;
+}
+
+double FrameProbe::getRateStdDev() {
+    if(windows < 2)
+        return 0.0;
+    double mean = rateSum/windows;
+    double var = rateSqSum/windows - mean*mean;
+    return (var > 0.0) ? sqrt(var) : 0.0;
+}
+
+void FrameProbe::onRead(yarp::sig::Image& image) {
+    double tcurrent = Time::now();
+    Stamp stm;
+    bool hasTimeStamp = getEnvelope(stm) && stm.isValid();
+
+    if(frames > 0)
+        intervals.add(tcurrent - tprev);
+    if(hasTimeStamp) {
+        if(stamped > 0)
+            senderIntervals.add(stm.getTime() - stprev);
+        sequence.add(stm.getCount());
+        latencies.add((tcurrent > stm.getTime()) ? tcurrent - stm.getTime() : 0.0);
+        stprev = stm.getTime();
+        stamped++;
+    }
+    tprev = tcurrent;
+    frames++;
+    bytes += image.getRawImageSize();
+
+    // frame rate over consecutive windows
+    if(windowStart < 0)
+        windowStart = tcurrent;
+    while(tcurrent - windowStart >= window) {
+        double rate = windowFrames/window;
+        minRate = (windows == 0 || rate < minRate) ? rate : minRate;
+        maxRate = (windows == 0 || rate > maxRate) ? rate : maxRate;
+        rateSum += rate;
+        rateSqSum += rate*rate;
+        windows++;
+        windowFrames = 0;
+        windowStart += window;
+    }
+    windowFrames++;
+
+    process(image);
+}
+
+void FrameProbe::process(yarp::sig::Image& image) {
+    if(checkContent)
+        content.check(image);
+}
+
+/**
+ * Sum and sum of squares of the bytes of a row, and a word-wise hash of them.
+ */
+static void rowStats(const unsigned char* row, size_t n,
+                     uint64_t& sum, uint64_t& sumSq, uint64_t& hash)
+{
+    const uint64_t prime = 0x9E3779B97F4A7C15ULL;
+    uint64_t h = 0xCBF29CE484222325ULL;
+    size_t i = 0;
+#if defined(__SSE2__)
+    __m128i zero = _mm_setzero_si128();
+    __m128i acc = _mm_setzero_si128();      // 2 x 64 bit
+    __m128i accSq = _mm_setzero_si128();    // 4 x 32 bit, enough for a row
+    for(; i+16 <= n; i+=16) {
+        __m128i v = _mm_loadu_si128((const __m128i*)(row+i));
+        acc = _mm_add_epi64(acc, _mm_sad_epu8(v, zero));
+        __m128i lo = _mm_unpacklo_epi8(v, zero);
+        __m128i hi = _mm_unpackhi_epi8(v, zero);
+        accSq = _mm_add_epi32(accSq, _mm_add_epi32(_mm_madd_epi16(lo, lo), _mm_madd_epi16(hi, hi)));
+        uint64_t w[2];
+        _mm_storeu_si128((__m128i*)w, v);
+        h = (h ^ w[0]) * prime;
+        h = (h ^ w[1]) * prime;
+    }
+    uint64_t s[2];
+    uint32_t sq[4];
+    _mm_storeu_si128((__m128i*)s, acc);
+    _mm_storeu_si128((__m128i*)sq, accSq);
+    sum += s[0] + s[1];
+    sumSq += (uint64_t)sq[0] + sq[1] + sq[2] + sq[3];
+#endif
+    for(; i+8 <= n; i+=8) {
+        uint64_t w;
+        memcpy(&w, row+i, 8);
+        h = (h ^ w) * prime;
+        for(size_t k=0; k<8; k++) {
+            sum += row[i+k];
+            sumSq += row[i+k]*row[i+k];
+        }
+    }
+    for(; i<n; i++) {
+        h = (h ^ row[i]) * prime;
+        sum += row[i];
+        sumSq += row[i]*row[i];
+    }
+    hash = h ^ (h >> 29);
+}
+
+void FrameContent::reset() {
+    rowHashes.clear();
+    prevHash = 0;
+    checked = 0;
+    repeated = repeatedRun = maxRepeatedRun = 0;
+    black = saturated = torn = 0;
+}
+
+void FrameContent::check(const yarp::sig::Image& image) {
+    size_t height = image.height();
+    size_t rowBytes = image.width()*image.getPixelSize();
+    if(height == 0 || rowBytes == 0)
+        return;
+
+    // allocated only when the size of the frames changes
+    if(currentHashes.size() != height) {
+        currentHashes.resize(height);
+        textured.resize(height);
+    }
+
+    uint64_t sum = 0, sumSq = 0;
+    uint64_t frameHash = 0;
+    double minRowVar = minStdDev*minStdDev;
+    for(size_t y=0; y<height; y++) {
+        uint64_t rowSum = 0, rowSumSq = 0;
+        rowStats(image.getRow(y), rowBytes, rowSum, rowSumSq, currentHashes[y]);
+        frameHash = (frameHash ^ currentHashes[y]) * 0x100000001B3ULL + y;
+        double rowMean = (double)rowSum/rowBytes;
+        textured[y] = ((double)rowSumSq/rowBytes - rowMean*rowMean >= minRowVar) ? 1 : 0;
+        sum += rowSum;
+        sumSq += rowSumSq;
+    }
+
+    double count = (double)height*rowBytes;
+    double mean = sum/count;
+    double var = sumSq/count - mean*mean;
+    double stdDev = (var > 0.0) ? sqrt(var) : 0.0;
+    if(stdDev < minStdDev && mean <= blackLevel)
+        black++;
+    if(stdDev < minStdDev && mean >= saturationLevel)
+        saturated++;
+
+    if(checked > 0 && rowHashes.size() == height) {
+        if(frameHash == prevHash) {
+            repeated++;
+            repeatedRun++;
+            maxRepeatedRun = (repeatedRun > maxRepeatedRun) ? repeatedRun : maxRepeatedRun;
+        }
+        else {
+            repeatedRun = 0;
+            // a block of rows still equal to the previous frame at the bottom
+            // (or at the top) and the rest changed: the buffer was partially overwritten.
+            // Flat rows (e.g. a black band of vignetting or a saturated ceiling) stay
+            // equal in any stream, so only the rows with some texture count
+            size_t bottom = 0, top = 0;
+            size_t bottomTextured = 0, topTextured = 0;
+            for(; bottom < height && currentHashes[height-1-bottom] == rowHashes[height-1-bottom]; bottom++)
+                bottomTextured += textured[height-1-bottom];
+            for(; top < height && currentHashes[top] == rowHashes[top]; top++)
+                topTextured += textured[top];
+            size_t block = (bottom > top) ? bottom : top;
+            size_t blockTextured = (bottom > top) ? bottomTextured : topTextured;
+            size_t same = 0;
+            for(size_t y=0; y<height; y++)
+                same += (currentHashes[y] == rowHashes[y]) ? 1 : 0;
+            if(blockTextured >= minTornRows && same == block)
+                torn++;
+        }
+    }
+
+    rowHashes.swap(currentHashes);
+    prevHash = frameHash;
+    checked++;
+}
+
+void PipelineMatcher::setStages(size_t count, size_t slotCount) {
+    stages = count;
+    slots.assign(slotCount, Slot());
+    hops.assign(count, Histogram());
+    cumulative.assign(count, Histogram());
+    matched.assign(count, 0);
+    missing.assign(count, 0);
+    unmatched.assign(count, 0);
+    reset();
+}
+
+void PipelineMatcher::reset() {
+    std::lock_guard<std::mutex> guard(mutex);
+    draining = false;
+    for(size_t i=0; i<slots.size(); i++) {
+        slots[i].count = -1;
+        slots[i].arrival.assign(stages, -1.0);
+    }
+    for(size_t k=0; k<stages; k++) {
+        hops[k].reset();
+        cumulative[k].reset();
+        matched[k] = missing[k] = unmatched[k] = 0;
+    }
+    sourceLatency.reset();
+    clock.reset();
+}
+
+void PipelineMatcher::record(size_t stage, const Stamp& stamp, double arrival) {
+    if(!stamp.isValid() || stage >= stages)
+        return;
+    std::lock_guard<std::mutex> guard(mutex);
+    Slot& slot = slots[stamp.getCount() % slots.size()];
+    bool same = (slot.count == stamp.getCount() && slot.time == stamp.getTime());
+
+    if(!same) {
+        // while draining only the frames already in flight are followed
+        if(draining)
+            return;
+        // the previous frame of the slot left the pipeline
+        release(slot);
+        slot.count = stamp.getCount();
+        slot.time = stamp.getTime();
+        slot.arrival.assign(stages, -1.0);
+    }
+
+    if(slot.arrival[stage] >= 0)
+        return;     // duplicated frame
+    slot.arrival[stage] = arrival;
+    if(stage == 0) {
+        sourceLatency.add(clock.add(stamp.getTime(), arrival));
+        // the callbacks of the other stages may have been served first
+        for(size_t k=1; k<stages; k++) {
+            if(slot.arrival[k] >= 0) {
+                matched[k]++;
+                cumulative[k].add(std::max(slot.arrival[k] - arrival, 0.0));
+            }
+        }
+    }
+    else if(slot.arrival[0] >= 0) {
+        matched[stage]++;
+        cumulative[stage].add(std::max(arrival - slot.arrival[0], 0.0));
+    }
+
+    // the callbacks of two stages may be served out of order
+    if(stage > 0 && slot.arrival[stage-1] >= 0)
+        hops[stage].add(std::max(arrival - slot.arrival[stage-1], 0.0));
+    if(stage+1 < stages && slot.arrival[stage+1] >= 0)
+        hops[stage+1].add(std::max(slot.arrival[stage+1] - arrival, 0.0));
+}
+
+void PipelineMatcher::drain() {
+    std::lock_guard<std::mutex> guard(mutex);
+    draining = true;
+}
+
+void PipelineMatcher::finish() {
+    std::lock_guard<std::mutex> guard(mutex);
+    for(size_t i=0; i<slots.size(); i++)
+        release(slots[i]);
+}
+
+void PipelineMatcher::release(Slot& slot) {
+    if(slot.count < 0)
+        return;
+    for(size_t k=1; k<stages; k++) {
+        if(slot.arrival[0] < 0)
+            unmatched[k] += (slot.arrival[k] >= 0) ? 1 : 0;
+        else
+            missing[k] += (slot.arrival[k] < 0) ? 1 : 0;
+    }
+    slot.count = -1;
+}
+
+void PipelineStage::onRead(yarp::sig::Image& image) {
+    double tcurrent = Time::now();
+    Stamp stm;
+    if(getEnvelope(stm))
+        matcher.record(index, stm, tcurrent);
+}
+
+void StereoProbe::process(yarp::sig::Image& image) {
+    Frame frame;
+    Stamp stm;
+    frame.arrival = Time::now();
+    frame.stamp = (getEnvelope(stm) && stm.isValid()) ? stm.getTime() : 0.0;
+    frameTimes.push_back(frame);
+    FrameProbe::process(image);
 }
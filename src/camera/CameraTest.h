@@ -22,9 +22,219 @@
 #define _CAMERATEST_H_
 
 #include <string>
+#include <vector>
+#include <stdint.h>
+#include <mutex>
 #include <yarp/robottestingframework/TestCase.h>
 #include <yarp/os/BufferedPort.h>
+#include <yarp/os/Stamp.h>
+#include <yarp/os/Bottle.h>
 #include <yarp/sig/Image.h>
+#include "Histogram.h"
+#include "SequenceAnalyzer.h"
+#include "ClockOffsetEstimator.h"
+
+
+/**
+ * Checks the content of the frames in place, without copying them out of the
+ * port buffer. In a single pass over each row it computes a word-wise hash and,
+ * with SSE2 where available, the sum and the sum of squares of the bytes:
+ *  - a frame with the same hash as the previous one is a repeated frame;
+ *  - a frame whose mean is below blackLevel (above saturationLevel) with a
+ *    standard deviation below minStdDev is a black (saturated) frame;
+ *  - a frame where only a block of rows at the bottom (or at the top) is identical
+ *    to the previous frame, with at least minTornRows of them not flat (standard
+ *    deviation of the row of at least minStdDev), is a torn frame, i.e. a buffer
+ *    partially overwritten.
+ */
+class FrameContent {
+public:
+    FrameContent() : blackLevel(16), saturationLevel(240), minStdDev(4), minTornRows(8) { reset(); }
+
+    void configure(double black, double saturation, double stdDev) {
+        blackLevel = black;
+        saturationLevel = saturation;
+        minStdDev = stdDev;
+    }
+
+    void reset();
+    void check(const yarp::sig::Image& image);
+
+    unsigned long getChecked() { return checked; }
+    unsigned long getRepeated() { return repeated; }
+    unsigned long getBlack() { return black; }
+    unsigned long getSaturated() { return saturated; }
+    unsigned long getTorn() { return torn; }
+    unsigned long getMaxRepeatedRun() { return maxRepeatedRun; }
+
+private:
+    double blackLevel, saturationLevel, minStdDev;
+    size_t minTornRows;
+    std::vector<uint64_t> rowHashes;        // of the previous frame
+    std::vector<uint64_t> currentHashes;
+    std::vector<unsigned char> textured;    // of the current frame: row not flat
+    uint64_t prevHash;
+    unsigned long checked;
+    unsigned long repeated, repeatedRun, maxRepeatedRun;
+    unsigned long black, saturated, torn;
+};
+
+
+/**
+ * Receives the frames in a callback and records, for each one, the arrival
+ * time and the envelope stamp: inter-frame intervals, frames missing from the
+ * stamp counts and the frame rate over consecutive windows.
+ */
+class FrameProbe : public yarp::os::BufferedPort<yarp::sig::Image> {
+public:
+    FrameProbe() : window(1.0), checkContent(false) { reset(); }
+
+    void setWindow(double seconds) { window = seconds; }
+    void setContentChecks(bool enable) { checkContent = enable; }
+    FrameContent& getContent() { return content; }
+    void reset();
+
+    virtual void onRead(yarp::sig::Image& image);
+
+    unsigned long getFrames() { return frames; }
+    unsigned long long getBytes() { return bytes; }
+    bool hasTimeStamp() { return stamped > 0; }
+    const Histogram& getIntervals() { return intervals; }
+    const Histogram& getLatencies() { return latencies; }
+    const Histogram& getSenderIntervals() { return senderIntervals; }
+    const SequenceAnalyzer& getSequence() { return sequence; }
+
+    // frame rate over the windows
+    unsigned long getWindows() { return windows; }
+    double getMinRate() { return minRate; }
+    double getMaxRate() { return maxRate; }
+    double getMeanRate() { return (windows>0) ? rateSum/windows : 0.0; }
+    double getRateStdDev();
+
+protected:
+    // called for every frame, after the timing has been recorded
+    virtual void process(yarp::sig::Image& image);
+
+private:
+    double window;
+    bool checkContent;
+    FrameContent content;
+    unsigned long frames, stamped;
+    unsigned long long bytes;
+    double tprev, stprev;
+    Histogram intervals;            // arrival time
+    Histogram latencies;            // arrival time - envelope time stamp
+    Histogram senderIntervals;      // envelope time stamp
+    SequenceAnalyzer sequence;
+    double windowStart;
+    unsigned long windowFrames;
+    unsigned long windows;
+    double minRate, maxRate, rateSum, rateSqSum;
+};
+
+
+/**
+ * A FrameProbe which also keeps the stamp time and the arrival time of
+ * every frame, to pair the frames of two cameras once the capture is over.
+ */
+class StereoProbe : public FrameProbe {
+public:
+    class Frame {
+    public:
+        double stamp;
+        double arrival;
+        double time(bool useStamp) const { return useStamp ? stamp : arrival; }
+    };
+
+    /** Allocates in advance the memory for the given number of frames. */
+    void reserve(size_t count) { frameTimes.reserve(count); }
+    void clear() { frameTimes.clear(); }
+    const std::vector<Frame>& getFrameTimes() { return frameTimes; }
+
+protected:
+    virtual void process(yarp::sig::Image& image);
+
+private:
+    std::vector<Frame> frameTimes;
+};
+
+
+/**
+ * Matches the frames received from the stages of a vision pipeline (e.g.
+ * /cam -> /camcalib -> consumer) by their envelope stamp, which the stages
+ * are expected to forward unchanged, and records for every stage the latency
+ * added w.r.t. the previous one (hop) and w.r.t. the first one (cumulative).
+ *
+ * The frames in flight are kept in a fixed number of slots indexed by the
+ * stamp count, so the memory does not depend on the duration of the test.
+ * A slot is opened by the first stage which receives the frame, as the
+ * callbacks of the stages may be served out of order. A frame evicted from
+ * its slot before reaching a stage is counted as missing at that stage, and
+ * so are the frames still waiting for a stage when finish() is called; a
+ * frame whose slot is evicted before the first stage received it is counted
+ * as unmatched.
+ */
+class PipelineMatcher {
+public:
+    PipelineMatcher() : stages(0), draining(false) { }
+
+    void setStages(size_t count, size_t slots=256);
+    void reset();
+
+    /** Called by the stage \c stage for every frame (thread safe). */
+    void record(size_t stage, const yarp::os::Stamp& stamp, double arrival);
+
+    /** Stops following new frames: only the ones already in flight are recorded. */
+    void drain();
+
+    /** Counts the frames which have not reached all the stages as missing. */
+    void finish();
+
+    size_t getStages() { return stages; }
+    const Histogram& getHop(size_t stage) { return hops[stage]; }
+    const Histogram& getCumulative(size_t stage) { return cumulative[stage]; }
+    const Histogram& getSourceLatency() { return sourceLatency; }
+    unsigned long getMatched(size_t stage) { return matched[stage]; }
+    unsigned long getMissing(size_t stage) { return missing[stage]; }
+    unsigned long getUnmatched(size_t stage) { return unmatched[stage]; }
+
+private:
+    class Slot {
+    public:
+        Slot() : count(-1), time(0.0) { }
+        int count;
+        double time;
+        std::vector<double> arrival;        // < 0 if not arrived yet
+    };
+
+    void release(Slot& slot);
+
+private:
+    std::mutex mutex;
+    size_t stages;
+    bool draining;
+    std::vector<Slot> slots;
+    std::vector<Histogram> hops;
+    std::vector<Histogram> cumulative;
+    Histogram sourceLatency;                // stamp of the source -> first stage
+    ClockOffsetEstimator clock;
+    std::vector<unsigned long> matched, missing, unmatched;
+};
+
+
+/**
+ * A stage of the pipeline: forwards the arrival time and the stamp of every
+ * frame to the matcher.
+ */
+class PipelineStage : public yarp::os::BufferedPort<yarp::sig::Image> {
+public:
+    PipelineStage(PipelineMatcher& matcher, size_t index) : matcher(matcher), index(index) { }
+    virtual void onRead(yarp::sig::Image& image);
+
+private:
+    PipelineMatcher& matcher;
+    size_t index;
+};
 
 
 /**
@@ -39,7 +249,41 @@
 * | measure_time   | int    |  s  | 1             | No      | The duration of the test. |  |
 * | expected_frequency | int    |  Hz  | 30           | No      | The expected framerate of the camera. |  |
 * | tolerance      | int    | Number of frames | 5    | No     | The tolerance on the total number of frames read during the period (expected_frequency*measure_time) to consider the test sucessful. |  |
+* | rate_window    | double |  s  | 1             | No      | The length of the windows over which the stability of the frame rate is computed. |  |
+* | max_interval_p99 | double | s | -             | No      | If given, the test fails when the 99th percentile of the inter-frame interval is higher. |  |
+* | tolerated_dropped_frames | int | Number of frames | - | No | If given, the test fails when more frames are missing from the envelope stamp counts. | Needs the camera to stamp its frames. |
+* | content_checks | bool   | -   | false         | No      | If true, the content of every frame is checked for repeated, black, saturated and torn frames. | See FrameContent. |
+* | black_level    | double | -   | 16            | No      | The mean pixel value below which a flat frame is black. |  |
+* | saturation_level | double | - | 240           | No      | The mean pixel value above which a flat frame is saturated. |  |
+* | min_std        | double | -   | 4             | No      | The standard deviation of the pixel values below which a frame is flat. |  |
+* | tolerated_bad_frames | int | Number of frames | 0 | No | The number of repeated, black, saturated or torn frames tolerated. |  |
+* | pipeline       | list   | -   | -             | No      | If given, the ports of the stages of a vision pipeline, e.g. (/icub/cam/left /icub/camcalib/left/out): the pipeline latency is measured instead, and portname is not needed. | The stages must forward the envelope of the frames. |
+* | max_pipeline_latency_p99 | double | s | -     | No      | If given, the test fails when the 99th percentile of the latency from the first to the last stage is higher. |  |
+* | stereo         | list   | -   | -             | No      | If given, the ports of the left and of the right camera, e.g. (/icub/cam/left /icub/cam/right): their synchronization is measured instead, and portname is not needed. |  |
+* | max_skew_p99   | double | s   | -             | No      | If given, the test fails when the 99th percentile of the left/right skew is higher. |  |
+* | max_unpaired_frames | int | Number of frames | - | No | If given, the test fails when more frames cannot be paired with a frame of the other camera. |  |
+* | max_skew_drift | double | s/s | -             | No      | If given, the test fails when the skew drifts faster. |  |
+* | benchmark      | bool   | -   | false         | No      | If true, a local fakeFrameGrabber is opened for every combination of resolutions and formats and its throughput is measured, and portname is not needed. |  |
+* | resolutions    | list   | pixels | ((320 240) (640 480)) | No | The resolutions of the benchmark. |  |
+* | formats        | list   | -   | (rgb)         | No      | The pixel formats of the benchmark: rgb, mono or bayer. |  |
+*
+* The frames are received in a callback, which records the arrival time and the
+* envelope stamp of every frame: the percentiles of the inter-frame interval, the frames
+* missing from the stamp counts and the frame rate over consecutive windows are reported.
 *
+* In pipeline mode all the stages are read at the same time and their frames are
+* matched by envelope stamp (see PipelineMatcher): the distribution of the latency added
+* by every stage and of the cumulative one are reported, to find the bottleneck of the chain.
+*
+* In stereo mode the two cameras are read at the same time and every frame is paired
+* with the nearest frame of the other camera, if closer than half of the expected period:
+* the percentiles of the skew, the unpaired frames and the drift of the skew are reported.
+*
+* In every mode reading a single camera, the throughput (MB/s), the latency from the
+* envelope stamp (which includes the clock offset for a remote camera) and the CPU used
+* by the test process are reported as well. In benchmark mode the CPU is measured with
+* and without the connection to the local grabber, and the difference is reported as
+* the CPU used by the transport and by the receiver.
 */
 class CameraTest : public yarp::robottestingframework::TestCase {
 public:
@@ -52,12 +296,35 @@ public:
 
     virtual void run();
 
+private:
+    void runPipeline();
+    void runStereo();
+    void runBenchmark();
+    void reportThroughput(const std::string& label, double duration, double cpu);
+
 private:
     std::string cameraPortName;
     int measure_time;
     int expected_frequency;
     int tolerance;
-    yarp::os::BufferedPort<yarp::sig::Image> port;
+    double rateWindow;
+    double maxIntervalP99;
+    int toleratedDroppedFrames;
+    bool contentChecks;
+    int toleratedBadFrames;
+    FrameProbe port;
+    std::vector<std::string> pipelinePortNames;
+    double maxPipelineLatencyP99;
+    PipelineMatcher matcher;
+    std::vector<PipelineStage*> stages;
+    std::vector<std::string> stereoPortNames;
+    double maxSkewP99;
+    int maxUnpairedFrames;
+    double maxSkewDrift;
+    StereoProbe stereo[2];
+    bool benchmark;
+    yarp::os::Bottle resolutions;
+    yarp::os::Bottle formats;
 };
 
 #endif //_CAMERATEST_H
@@ -0,0 +1,87 @@
+/*
+ * iCub Robot Unit Tests (Robot Testing Framework)
+ *
+ * Copyright (C) 2015-2019 Istituto Italiano di Tecnologia (IIT)
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+#include "ClockOffsetEstimator.h"
+
+ClockOffsetEstimator::ClockOffsetEstimator(double blockDuration, unsigned int blocks) :
+    blockDuration(blockDuration), blocks(blocks) {
+    reset();
+}
+
+void ClockOffsetEstimator::reset() {
+    blocks.clear();
+    current.time = current.minDelay = 0.0;
+    blockStart = 0.0;
+    started = false;
+    offset = drift = 0.0;
+}
+
+double ClockOffsetEstimator::add(double senderTime, double receiverTime) {
+    double delay = receiverTime - senderTime;
+
+    if(!started) {
+        started = true;
+        blockStart = receiverTime;
+        current.time = receiverTime;
+        current.minDelay = delay;
+    }
+    else if(receiverTime - blockStart >= blockDuration) {
+        blocks.push(current);
+        updateDrift();
+        blockStart = receiverTime;
+        current.time = receiverTime;
+        current.minDelay = delay;
+    }
+    else if(delay < current.minDelay) {
+        current.time = receiverTime;
+        current.minDelay = delay;
+    }
+
+    // lower envelope of the delays, each minimum brought forward
+    // to the current time with the estimated drift
+    offset = current.minDelay + drift*(receiverTime - current.time);
+    for(size_t i=0; i<blocks.size(); i++) {
+        double estimate = blocks[i].minDelay + drift*(receiverTime - blocks[i].time);
+        offset = (estimate < offset) ? estimate : offset;
+    }
+
+    double latency = delay - offset;
+    return (latency > 0.0) ? latency : 0.0;
+}
+
+void ClockOffsetEstimator::updateDrift() {
+    if(blocks.size() < 2) {
+        drift = 0.0;
+        return;
+    }
+    // least-squares slope of the block minima
+    double t0 = blocks[0].time;
+    double st = 0.0, sd = 0.0, stt = 0.0, sdt = 0.0;
+    size_t n = blocks.size();
+    for(size_t i=0; i<n; i++) {
+        double t = blocks[i].time - t0;
+        st += t;
+        sd += blocks[i].minDelay;
+        stt += t*t;
+        sdt += t*blocks[i].minDelay;
+    }
+    double den = n*stt - st*st;
+    drift = (den > 0.0) ? (n*sdt - st*sd)/den : 0.0;
+}
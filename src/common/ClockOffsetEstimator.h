@@ -0,0 +1,78 @@
+/*
+ * iCub Robot Unit Tests (Robot Testing Framework)
+ *
+ * Copyright (C) 2015-2019 Istituto Italiano di Tecnologia (IIT)
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+#ifndef _CLOCKOFFSETESTIMATOR_H_
+#define _CLOCKOFFSETESTIMATOR_H_
+
+#include "RingBuffer.h"
+
+/**
+ * Separates the clock offset between a sender and a receiver from the
+ * one-way transport latency, using only the sender time stamps and the
+ * receiver arrival times (minimum-delay tracking filter).
+ *
+ * The measured delay d = receiverTime - senderTime is the sum of the clock
+ * offset and of the latency; the fastest messages are assumed to have a
+ * negligible latency, so the offset is tracked as the lower envelope of d.
+ * The minimum of d is kept for each block of \c blockDuration seconds over
+ * the last \c blocks blocks, and a least-squares line through these minima
+ * gives the drift of the two clocks. Memory and cost per sample are constant.
+ *
+ * It does not need any cooperation from the sender and works equally well
+ * with two processes on the same machine (offset close to zero).
+ */
+class ClockOffsetEstimator {
+public:
+    ClockOffsetEstimator(double blockDuration=1.0, unsigned int blocks=30);
+
+    void reset();
+
+    /**
+     * Adds a message and returns its latency corrected for the
+     * estimated clock offset (always >= 0).
+     */
+    double add(double senderTime, double receiverTime);
+
+    /** The estimated offset (receiver clock - sender clock) at the last message. */
+    double getOffset() const { return offset; }
+
+    /** The estimated drift of the receiver clock w.r.t. the sender one (s/s). */
+    double getDrift() const { return drift; }
+
+private:
+    class Block {
+    public:
+        double time;            // receiver time of the minimum delay
+        double minDelay;
+    };
+
+    void updateDrift();
+
+private:
+    double blockDuration;
+    RingBuffer<Block> blocks;
+    Block current;
+    double blockStart;
+    bool started;
+    double offset;
+    double drift;
+};
+
+#endif //_CLOCKOFFSETESTIMATOR_H_
@@ -0,0 +1,283 @@
+/*
+ * iCub Robot Unit Tests (Robot Testing Framework)
+ *
+ * Copyright (C) 2015-2019 Istituto Italiano di Tecnologia (IIT)
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+#include <cmath>
+#include <fstream>
+#include <algorithm>
+#include <yarp/os/Time.h>
+#include <yarp/os/Vocab.h>
+#include <robottestingframework/TestAssert.h>
+#include "ControlBoardHelper.h"
+
+using namespace yarp::os;
+using namespace yarp::dev;
+
+#define MODE_POLLING_PERIOD     0.01        //seconds
+#define HOME_POLLING_PERIOD     0.2         //seconds, without timed encoders
+#define STREAM_POLLING_PERIOD   0.002       //seconds, well below the period of the state stream
+#define SETTLING_WINDOW         0.05        //seconds in tolerance before a joint is settled
+
+
+ControlBoardHelper::ControlBoardHelper() :
+    icmd(NULL), iimd(NULL), ipos(NULL), ienc(NULL), iencTimed(NULL), axes(0), interrupted(false) {
+}
+
+bool ControlBoardHelper::configure(PolyDriver* driver, const std::vector<int>& joints) {
+    if(!driver || !driver->isValid()) {
+        error = "the device is not open";
+        return false;
+    }
+    if(!driver->view(icmd) || !driver->view(iimd) || !driver->view(ipos) || !driver->view(ienc)
+       || !icmd || !iimd || !ipos || !ienc) {
+        error = "unable to open the control mode, interaction mode, position or encoders interface";
+        return false;
+    }
+    // optional: without it the motion is waited for by polling
+    if(!driver->view(iencTimed))
+        iencTimed = NULL;
+    if(!ienc->getAxes(&axes)) {
+        error = "unable to get the number of axes";
+        return false;
+    }
+    for(size_t i=0; i<joints.size(); i++) {
+        if(joints[i] < 0 || joints[i] >= axes) {
+            error = robottestingframework::Asserter::format("joint %d out of range (%d axes)", joints[i], axes);
+            return false;
+        }
+    }
+    this->joints = joints;
+    controlModes.resize(joints.size());
+    interactionModes.resize(joints.size());
+    targets.resize(joints.size());
+    encoders.resize(axes);
+    stamps.resize(axes);
+    return true;
+}
+
+bool ControlBoardHelper::setModes(int controlMode, InteractionModeEnum interactionMode) {
+    // the interaction modes are set even if some joint refused the control
+    // mode, as the joint by joint calls did
+    bool ok = setControlModes(controlMode);
+    if(!iimd)
+        return false;
+    std::fill(interactionModes.begin(), interactionModes.end(), interactionMode);
+    if(!iimd->setInteractionModes((int)joints.size(), joints.data(), interactionModes.data())) {
+        // a refused joint fails the whole batch: the others are set one by one
+        std::string refused;
+        for(size_t i=0; i<joints.size(); i++)
+            if(!iimd->setInteractionMode(joints[i], interactionMode))
+                refused += " " + std::to_string(joints[i]);
+        if(!refused.empty()) {
+            error = (ok ? "" : error + "; ") + "interaction mode refused by joints" + refused;
+            return false;
+        }
+    }
+    return ok;
+}
+
+bool ControlBoardHelper::setControlModes(int controlMode) {
+    if(!icmd) {
+        error = "not configured";
+        return false;
+    }
+    std::fill(controlModes.begin(), controlModes.end(), controlMode);
+    if(!icmd->setControlModes((int)joints.size(), joints.data(), controlModes.data())) {
+        // a refused joint fails the whole batch: the others are set one by one
+        std::string refused;
+        for(size_t i=0; i<joints.size(); i++)
+            if(!icmd->setControlMode(joints[i], controlMode))
+                refused += " " + std::to_string(joints[i]);
+        if(!refused.empty()) {
+            error = "control mode refused by joints" + refused;
+            return false;
+        }
+    }
+    return true;
+}
+
+bool ControlBoardHelper::checkModes(int controlMode, InteractionModeEnum interactionMode) {
+    if(!icmd->getControlModes((int)joints.size(), joints.data(), controlModes.data()) ||
+       !iimd->getInteractionModes((int)joints.size(), joints.data(), interactionModes.data())) {
+        error = "getControlModes/getInteractionModes failed";
+        return false;
+    }
+    for(size_t i=0; i<joints.size(); i++) {
+        if(controlModes[i] != controlMode || interactionModes[i] != interactionMode) {
+            error = robottestingframework::Asserter::format("joint %d is in mode (%s,%s), it should be (%s,%s)", joints[i],
+                                                            Vocab32::decode((NetInt32)controlModes[i]).c_str(),
+                                                            Vocab32::decode((NetInt32)interactionModes[i]).c_str(),
+                                                            Vocab32::decode((NetInt32)controlMode).c_str(),
+                                                            Vocab32::decode((NetInt32)interactionMode).c_str());
+            return false;
+        }
+    }
+    return true;
+}
+
+bool ControlBoardHelper::verifyModes(int controlMode, InteractionModeEnum interactionMode, double timeout) {
+    if(!icmd) {
+        error = "not configured";
+        return false;
+    }
+    double start = Time::now();
+    while(!checkModes(controlMode, interactionMode)) {
+        if(stopIfInterrupted())
+            return false;
+        if(Time::now() - start > timeout)
+            return false;
+        Time::delay(MODE_POLLING_PERIOD);
+    }
+    return true;
+}
+
+bool ControlBoardHelper::setAndVerifyModes(int controlMode, InteractionModeEnum interactionMode, double timeout) {
+    return setModes(controlMode, interactionMode) && verifyModes(controlMode, interactionMode, timeout);
+}
+
+bool ControlBoardHelper::goHome(const std::vector<double>& positions, const std::vector<double>& speeds,
+                                double tolerance, double timeout, double* settlingTime) {
+    tolerances.assign(joints.size(), tolerance);
+    return goHome(positions, speeds, tolerances, timeout, settlingTime);
+}
+
+bool ControlBoardHelper::goHome(const std::vector<double>& positions, const std::vector<double>& speeds,
+                                const std::vector<double>& tolerances, double timeout, double* settlingTime) {
+    if(!ipos) {
+        error = "not configured";
+        return false;
+    }
+    if(positions.size() != joints.size() || speeds.size() != joints.size()) {
+        error = "one home position and one speed per joint are needed";
+        return false;
+    }
+    targets = speeds;
+    if(!ipos->setRefSpeeds((int)joints.size(), joints.data(), targets.data())) {
+        error = "setRefSpeeds failed";
+        return false;
+    }
+    targets = positions;
+    if(!ipos->positionMove((int)joints.size(), joints.data(), targets.data())) {
+        error = "positionMove failed";
+        return false;
+    }
+    return waitMotionDone(positions, tolerances, timeout, settlingTime);
+}
+
+bool ControlBoardHelper::waitMotionDone(const std::vector<double>& positions, double tolerance,
+                                        double timeout, double* settlingTime) {
+    tolerances.assign(joints.size(), tolerance);
+    return waitMotionDone(positions, tolerances, timeout, settlingTime);
+}
+
+bool ControlBoardHelper::waitMotionDone(const std::vector<double>& positions, const std::vector<double>& tolerances,
+                                        double timeout, double* settlingTime) {
+    if(!ienc) {
+        error = "not configured";
+        return false;
+    }
+    if(positions.size() != joints.size() || tolerances.size() != joints.size()) {
+        error = "one position and one tolerance per joint are needed";
+        return false;
+    }
+    if(joints.empty()) {
+        if(settlingTime)
+            *settlingTime = 0.0;
+        return true;
+    }
+
+    double start = Time::now();
+    double lastStamp = -1.0;
+    double inToleranceSince = -1.0;
+    int samplesInTolerance = 0;
+    while(true) {
+        if(stopIfInterrupted())
+            return false;
+        double now = Time::now();
+        bool fresh = false;
+        if(iencTimed) {
+            // the stream of a remote_controlboard is read locally: only
+            // the samples not seen yet are checked
+            if(iencTimed->getEncodersTimed(encoders.data(), stamps.data()) && stamps[joints[0]] != lastStamp) {
+                lastStamp = stamps[joints[0]];
+                fresh = true;
+            }
+        }
+        else {
+            fresh = ienc->getEncoders(encoders.data());
+        }
+        if(fresh) {
+            bool inPosition = true;
+            for(size_t i=0; i<joints.size() && inPosition; i++)
+                inPosition = fabs(encoders[joints[i]] - positions[i]) < tolerances[i];
+            if(!inPosition) {
+                inToleranceSince = -1.0;
+                samplesInTolerance = 0;
+            }
+            else if(samplesInTolerance++ == 0)
+                inToleranceSince = now;
+        }
+        // without a stream the old behaviour: done as soon as in tolerance;
+        // with it, a new sample must confirm the position during the settling
+        // window, so that a stalled stream does not pass for settled joints
+        if(inToleranceSince >= 0.0 &&
+           (!iencTimed || (now - inToleranceSince >= SETTLING_WINDOW && samplesInTolerance > 1)))
+            break;
+        if(now - start > timeout) {
+            if(iencTimed && lastStamp < 0.0)
+                error = "no data from the timed encoders";
+            else
+                error = "timeout while reaching the target positions";
+            return false;
+        }
+        Time::delay(iencTimed ? STREAM_POLLING_PERIOD : HOME_POLLING_PERIOD);
+    }
+    if(settlingTime)
+        *settlingTime = inToleranceSince - start;
+    return true;
+}
+
+bool ControlBoardHelper::goHome(const std::vector<double>& positions, double speed,
+                                double tolerance, double timeout, double* settlingTime) {
+    return goHome(positions, std::vector<double>(joints.size(), speed), tolerance, timeout, settlingTime);
+}
+
+bool ControlBoardHelper::stopIfInterrupted() {
+    if(!interrupted)
+        return false;
+    if(ipos && !joints.empty())
+        ipos->stop((int)joints.size(), joints.data());
+    error = "interrupted, the joints have been stopped";
+    return true;
+}
+
+bool ControlBoardHelper::saveToFile(const std::string& filename, const Bottle& b) {
+    std::fstream fs;
+    fs.open(filename.c_str(), std::fstream::out);
+    if(!fs.is_open())
+        return false;
+    for(size_t i=0; i<b.size(); i++) {
+        std::string s = b.get(i).toString();
+        std::replace(s.begin(), s.end(), '(', ' ');
+        std::replace(s.begin(), s.end(), ')', ' ');
+        fs << s << std::endl;
+    }
+    fs.close();
+    return true;
+}
@@ -0,0 +1,156 @@
+/*
+ * iCub Robot Unit Tests (Robot Testing Framework)
+ *
+ * Copyright (C) 2015-2019 Istituto Italiano di Tecnologia (IIT)
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+#ifndef _CONTROLBOARDHELPER_H_
+#define _CONTROLBOARDHELPER_H_
+
+#include <string>
+#include <vector>
+#include <atomic>
+#include <yarp/os/Bottle.h>
+#include <yarp/dev/PolyDriver.h>
+#include <yarp/dev/ControlBoardInterfaces.h>
+
+/**
+ * The operations shared by the tests which drive a set of joints of a
+ * control board: switching and verifying the control and interaction modes,
+ * moving the joints home and saving the collected data.
+ *
+ * The modes of all the joints are set with a single multi-joint call
+ * (setControlModes, setInteractionModes) and confirmed with a single
+ * multi-joint query per check, so switching a whole part takes about one
+ * round trip instead of a few for each joint.
+ *
+ * The methods do not assert: they return false on failure and getError()
+ * describes it, so that each test decides how to report it.
+ *
+ * interrupt() may be called from any thread (e.g. the interrupt() of the
+ * test): the thread which drives the joints stops them at its next check,
+ * i.e. in the waits of the helper or in stopIfInterrupted().
+ */
+class ControlBoardHelper {
+public:
+    ControlBoardHelper();
+
+    /** Views the interfaces of an open driver and selects the joints to drive. */
+    bool configure(yarp::dev::PolyDriver* driver, const std::vector<int>& joints);
+
+    const std::vector<int>& getJoints() const { return joints; }
+    int getAxes() const { return axes; }
+    std::string getError() const { return error; }
+
+    /**
+     * Sets the same control and interaction mode on all the joints. The
+     * interaction modes are set even if the control modes are refused, and
+     * if a joint refuses a mode the others are set one by one, so they
+     * switch anyway; getError() tells which joints refused.
+     */
+    bool setModes(int controlMode, yarp::dev::InteractionModeEnum interactionMode=yarp::dev::VOCAB_IM_STIFF);
+
+    /** Sets the control mode only, leaving the interaction mode unchanged. */
+    bool setControlModes(int controlMode);
+
+    /**
+     * Waits until all the joints are in the given modes.
+     * @param timeout in seconds
+     */
+    bool verifyModes(int controlMode, yarp::dev::InteractionModeEnum interactionMode, double timeout=20.0);
+
+    /** setModes() followed by verifyModes(). */
+    bool setAndVerifyModes(int controlMode, yarp::dev::InteractionModeEnum interactionMode=yarp::dev::VOCAB_IM_STIFF,
+                           double timeout=20.0);
+
+    /**
+     * Moves all the joints to the given positions (one per joint) in position
+     * control and waits with waitMotionDone() until all of them are settled.
+     * @param speeds the reference speeds, one per joint
+     * @param settlingTime if given, the time it took to reach the positions
+     */
+    bool goHome(const std::vector<double>& positions, const std::vector<double>& speeds,
+                double tolerance=0.5, double timeout=20.0, double* settlingTime=NULL);
+
+    /** As above, with a tolerance for each joint. */
+    bool goHome(const std::vector<double>& positions, const std::vector<double>& speeds,
+                const std::vector<double>& tolerances, double timeout=20.0, double* settlingTime=NULL);
+
+    /** As above, with the same reference speed for all the joints. */
+    bool goHome(const std::vector<double>& positions, double speed=20.0,
+                double tolerance=0.5, double timeout=20.0, double* settlingTime=NULL);
+
+    /**
+     * Waits until all the joints are within the tolerance of the given
+     * positions (one per joint) and stay there for a short settling window.
+     *
+     * The positions are read from the timed encoders of the driver, which a
+     * remote_controlboard serves from the part's streamed state
+     * (stateExt:o) without any rpc, so each new sample is checked as soon
+     * as it arrives; at least one new sample within the tolerance is needed
+     * after the settling window started. If the driver has no timed
+     * encoders, the encoders are polled instead.
+     * @param timeout in seconds
+     * @param settlingTime if given, the time from the call until the joints
+     *        entered the tolerance for good
+     */
+    bool waitMotionDone(const std::vector<double>& positions, double tolerance=0.5,
+                        double timeout=20.0, double* settlingTime=NULL);
+
+    /** As above, with a tolerance for each joint. */
+    bool waitMotionDone(const std::vector<double>& positions, const std::vector<double>& tolerances,
+                        double timeout=20.0, double* settlingTime=NULL);
+
+    /** Requests to stop the joints and to end the waits with an error. */
+    void interrupt() { interrupted = true; }
+    bool isInterrupted() const { return interrupted; }
+
+    /**
+     * Stops the joints if interrupt() was called.
+     * @return true if the joints have been stopped, i.e. the test must end
+     */
+    bool stopIfInterrupted();
+
+    /**
+     * Saves a bottle to a text file, one line per element and without
+     * the parentheses of the nested lists (e.g. to be loaded in Matlab).
+     */
+    static bool saveToFile(const std::string& filename, const yarp::os::Bottle& b);
+
+private:
+    bool checkModes(int controlMode, yarp::dev::InteractionModeEnum interactionMode);
+
+private:
+    yarp::dev::IControlMode* icmd;
+    yarp::dev::IInteractionMode* iimd;
+    yarp::dev::IPositionControl* ipos;
+    yarp::dev::IEncoders* ienc;
+    yarp::dev::IEncodersTimed* iencTimed;
+    int axes;
+    std::vector<int> joints;
+    // buffers of the multi-joint calls, allocated once in configure()
+    std::vector<int> controlModes;
+    std::vector<yarp::dev::InteractionModeEnum> interactionModes;
+    std::vector<double> encoders;
+    std::vector<double> stamps;
+    std::vector<double> targets;
+    std::vector<double> tolerances;
+    std::string error;
+    std::atomic<bool> interrupted;
+};
+
+#endif //_CONTROLBOARDHELPER_H_
@@ -0,0 +1,103 @@
+/*
+ * iCub Robot Unit Tests (Robot Testing Framework)
+ *
+ * Copyright (C) 2015-2019 Istituto Italiano di Tecnologia (IIT)
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+#include <math.h>
+#include <cstdio>
+#include <chrono>
+#include <thread>
+#include "FixedRateScheduler.h"
+
+#if !defined(_WIN32)
+    #include <time.h>
+    #include <errno.h>
+#endif
+
+
+FixedRateScheduler::FixedRateScheduler(double period) :
+    period(period), startTime(0.0), deadline(0.0), lastWakeup(0.0),
+    overruns(0), skipped(0), sumSquaredError(0.0), periods(1e-5, 100.0) {
+}
+
+double FixedRateScheduler::now() {
+    return std::chrono::duration<double>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+void FixedRateScheduler::sleepUntil(double time) {
+#if !defined(_WIN32)
+    // steady_clock is CLOCK_MONOTONIC: sleep on the absolute deadline,
+    // immune to the wake-up delays of a relative sleep
+    struct timespec ts;
+    ts.tv_sec = (time_t)time;
+    ts.tv_nsec = (long)((time - (double)ts.tv_sec) * 1e9);
+    // restarted only when interrupted by a signal: any other error
+    // (e.g. EINVAL) would fail again at once
+    while(clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &ts, NULL) == EINTR) { }
+#else
+    std::this_thread::sleep_until(std::chrono::steady_clock::time_point(
+        std::chrono::duration_cast<std::chrono::steady_clock::duration>(std::chrono::duration<double>(time))));
+#endif
+}
+
+void FixedRateScheduler::start() {
+    overruns = skipped = 0;
+    sumSquaredError = 0.0;
+    periods.reset();
+    startTime = lastWakeup = now();
+    deadline = startTime + period;
+}
+
+bool FixedRateScheduler::waitNext() {
+    bool inTime = true;
+    double current = now();
+    if(current >= deadline) {
+        // overrun: skip the deadlines already missed and wait for the next one
+        inTime = false;
+        overruns++;
+        unsigned long missed = (unsigned long)floor((current - deadline) / period) + 1;
+        skipped += missed - 1;
+        deadline += missed * period;
+    }
+    sleepUntil(deadline);
+    deadline += period;
+
+    current = now();
+    double actual = current - lastWakeup;
+    lastWakeup = current;
+    periods.add(actual);
+    sumSquaredError += (actual - period) * (actual - period);
+    return inTime;
+}
+
+double FixedRateScheduler::elapsed() const {
+    return now() - startTime;
+}
+
+double FixedRateScheduler::getJitter() const {
+    return (getCycles() > 0) ? sqrt(sumSquaredError / getCycles()) : 0.0;
+}
+
+std::string FixedRateScheduler::report() const {
+    char buff[256];
+    snprintf(buff, sizeof(buff),
+             "Sampling: %lu cycles, period %.3f ms (nominal %.3f ms, p99 %.3f ms, max %.3f ms), jitter %.3f ms, %lu overruns, %lu skipped",
+             getCycles(), getMeanPeriod()*1e3, period*1e3, periods.getPercentile(99.0)*1e3,
+             getMaxPeriod()*1e3, getJitter()*1e3, overruns, skipped);
+    return std::string(buff);
+}
@@ -0,0 +1,100 @@
+/*
+ * iCub Robot Unit Tests (Robot Testing Framework)
+ *
+ * Copyright (C) 2015-2019 Istituto Italiano di Tecnologia (IIT)
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+#ifndef _FIXEDRATESCHEDULER_H_
+#define _FIXEDRATESCHEDULER_H_
+
+#include <string>
+#include "Histogram.h"
+
+/**
+ * Paces an acquisition loop at a fixed rate:
+ *
+ *     FixedRateScheduler scheduler(0.01);
+ *     scheduler.start();
+ *     while (...) {
+ *         ... read and command ...
+ *         scheduler.waitNext();
+ *     }
+ *     ROBOTTESTINGFRAMEWORK_TEST_REPORT(scheduler.report());
+ *
+ * The deadlines are absolute (start + k * period), so the time spent in the
+ * loop body does not add to the period and the rate does not drift. When an
+ * iteration overruns its deadline, the deadlines already missed are skipped
+ * and counted, so that the loop stays in phase instead of bursting to catch
+ * up: the next wake-up is the next deadline still ahead, so an overrun of
+ * any length, even a small one, lengthens that cycle by a whole period.
+ *
+ * The deadlines are on the monotonic clock of the host (steady_clock), not
+ * on yarp::os::Time: with a simulated YARP clock (e.g. the one published by
+ * Gazebo) the loop is paced in real time, while the timeouts the tests
+ * measure with yarp::os::Time run on the simulated time, so the two differ
+ * by the real time factor of the simulation.
+ *
+ * The actual period of each iteration is recorded: its mean, jitter (the
+ * RMS deviation from the nominal period) and percentiles describe how good
+ * the sampling clock was.
+ */
+class FixedRateScheduler {
+public:
+    FixedRateScheduler(double period=0.01);
+
+    void setPeriod(double period) { this->period = period; }
+    double getPeriod() const { return period; }
+
+    /** Resets the statistics; the first deadline is one period from now. */
+    void start();
+
+    /**
+     * Sleeps until the next deadline.
+     * @return false if the deadline had already passed (an overrun)
+     */
+    bool waitNext();
+
+    /** Seconds since start() on the monotonic clock used for the deadlines. */
+    double elapsed() const;
+
+    unsigned long getCycles() const { return periods.getCount(); }
+    unsigned long getOverruns() const { return overruns; }
+    unsigned long getSkipped() const { return skipped; }
+    double getMeanPeriod() const { return periods.getMean(); }
+    double getJitter() const;
+    double getMaxPeriod() const { return periods.getMax(); }
+    const Histogram& getPeriods() const { return periods; }
+
+    /** A one-line summary of the statistics, to be attached to the report. */
+    std::string report() const;
+
+private:
+    static double now();
+    static void sleepUntil(double time);
+
+private:
+    double period;
+    double startTime;
+    double deadline;
+    double lastWakeup;
+    unsigned long overruns;
+    unsigned long skipped;
+    double sumSquaredError;
+    Histogram periods;
+};
+
+#endif //_FIXEDRATESCHEDULER_H_
@@ -0,0 +1,87 @@
+/*
+ * iCub Robot Unit Tests (Robot Testing Framework)
+ *
+ * Copyright (C) 2015-2019 Istituto Italiano di Tecnologia (IIT)
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+#include <math.h>
+#include "Histogram.h"
+
+Histogram::Histogram(double lowest, double highest, unsigned int subBuckets) :
+    lowest(lowest), subBuckets(subBuckets) {
+    // bucket 0 collects everything below 'lowest', then 'subBuckets'
+    // linear buckets for each power of two up to 'highest'
+    unsigned int octaves = (unsigned int)ceil(log2(highest/lowest)) + 1;
+    buckets.resize(1 + octaves*subBuckets);
+    reset();
+}
+
+void Histogram::reset() {
+    for(unsigned int i=0; i<buckets.size(); i++)
+        buckets[i] = 0;
+    count = 0;
+    min = max = sum = 0.0;
+}
+
+void Histogram::add(double value) {
+    buckets[indexOf(value)]++;
+    min = (count==0 || value < min) ? value : min;
+    max = (count==0 || value > max) ? value : max;
+    sum += value;
+    count++;
+}
+
+double Histogram::getPercentile(double percentile) const {
+    if(count == 0)
+        return 0.0;
+    unsigned long rank = (unsigned long)ceil(percentile/100.0 * count);
+    rank = (rank < 1) ? 1 : rank;
+    if(rank >= count)
+        return max;
+    unsigned long cumulative = 0;
+    for(unsigned int i=0; i<buckets.size(); i++) {
+        cumulative += buckets[i];
+        if(cumulative >= rank) {
+            double value = valueOf(i);
+            // the exact extremes are known, never report past them
+            value = (value < min) ? min : value;
+            value = (value > max) ? max : value;
+            return value;
+        }
+    }
+    return max;
+}
+
+unsigned int Histogram::indexOf(double value) const {
+    double u = value/lowest;
+    if(!(u >= 1.0))     // also catches NaN
+        return 0;
+    int exponent;
+    double mantissa = frexp(u, &exponent);     // u = mantissa * 2^exponent, mantissa in [0.5, 1)
+    unsigned int index = 1 + (exponent-1)*subBuckets
+                           + (unsigned int)((2.0*mantissa - 1.0)*subBuckets);
+    return (index < buckets.size()) ? index : buckets.size()-1;
+}
+
+double Histogram::valueOf(unsigned int index) const {
+    if(index == 0)
+        return lowest;
+    unsigned int octave = (index-1) / subBuckets;
+    unsigned int sub = (index-1) % subBuckets;
+    // middle of the bucket
+    return lowest * ldexp(1.0 + (sub+0.5)/subBuckets, octave);
+}
@@ -0,0 +1,65 @@
+/*
+ * iCub Robot Unit Tests (Robot Testing Framework)
+ *
+ * Copyright (C) 2015-2019 Istituto Italiano di Tecnologia (IIT)
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+#ifndef _HISTOGRAM_H_
+#define _HISTOGRAM_H_
+
+#include <vector>
+
+/**
+ * A constant-memory histogram with logarithmically spaced buckets
+ * (in the spirit of HdrHistogram).
+ *
+ * Values between \c lowest and \c highest are recorded with a relative
+ * error of about 1/subBuckets; values outside that range are clamped to
+ * the first or last bucket. The exact minimum, maximum and mean are kept
+ * aside, so a single outlier is never lost.
+ */
+class Histogram {
+public:
+    Histogram(double lowest=1e-6, double highest=100.0, unsigned int subBuckets=32);
+
+    void reset();
+    void add(double value);
+
+    /**
+     * Returns the value below which the given percentage of the samples fall.
+     * @param percentile in the range [0 .. 100], e.g. 99.9
+     */
+    double getPercentile(double percentile) const;
+
+    unsigned long getCount() const { return count; }
+    double getMin() const { return min; }
+    double getMax() const { return max; }
+    double getMean() const { return (count>0) ? sum/count : 0.0; }
+
+private:
+    unsigned int indexOf(double value) const;
+    double valueOf(unsigned int index) const;
+
+private:
+    double lowest;
+    unsigned int subBuckets;
+    std::vector<unsigned long> buckets;
+    unsigned long count;
+    double min, max, sum;
+};
+
+#endif //_HISTOGRAM_H_
@@ -0,0 +1,144 @@
+/*
+ * iCub Robot Unit Tests (Robot Testing Framework)
+ *
+ * Copyright (C) 2015-2019 Istituto Italiano di Tecnologia (IIT)
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+#include <math.h>
+#include <algorithm>
+#include "LeastSquares.h"
+
+LeastSquares::LeastSquares(size_t regressors, size_t outputs) {
+    configure(regressors, outputs);
+}
+
+void LeastSquares::configure(size_t regressors, size_t outputs) {
+    this->regressors = regressors;
+    this->outputs = outputs;
+    mean_x.resize(regressors);
+    mean_y.resize(outputs);
+    cxx.resize(regressors*regressors);
+    cxy.resize(regressors*outputs);
+    cyy.resize(outputs);
+    dx.resize(regressors);
+    chol.resize(regressors*regressors);
+    coeffs.resize(outputs*regressors);
+    intercepts.resize(outputs);
+    residuals.resize(outputs);
+    clear();
+}
+
+void LeastSquares::clear() {
+    samples = 0;
+    std::fill(mean_x.begin(), mean_x.end(), 0.0);
+    std::fill(mean_y.begin(), mean_y.end(), 0.0);
+    std::fill(cxx.begin(), cxx.end(), 0.0);
+    std::fill(cxy.begin(), cxy.end(), 0.0);
+    std::fill(cyy.begin(), cyy.end(), 0.0);
+    std::fill(coeffs.begin(), coeffs.end(), 0.0);
+    std::fill(intercepts.begin(), intercepts.end(), 0.0);
+    std::fill(residuals.begin(), residuals.end(), 0.0);
+    error.clear();
+}
+
+void LeastSquares::add(const double* x, const double* y) {
+    samples++;
+    double n = (double)samples;
+    // C += (v - old mean) (w - new mean)'
+    for(size_t j=0; j<regressors; j++) {
+        dx[j] = x[j] - mean_x[j];
+        mean_x[j] += dx[j] / n;
+    }
+    for(size_t i=0; i<regressors; i++)
+        for(size_t j=i; j<regressors; j++)
+            cxx[i*regressors + j] += dx[i] * (x[j] - mean_x[j]);
+    for(size_t k=0; k<outputs; k++) {
+        double dy = y[k] - mean_y[k];
+        mean_y[k] += dy / n;
+        double ry = y[k] - mean_y[k];
+        cyy[k] += dy * ry;
+        for(size_t j=0; j<regressors; j++)
+            cxy[j*outputs + k] += dx[j] * ry;
+    }
+}
+
+bool LeastSquares::solve() {
+    error.clear();
+    if(samples <= regressors) {
+        error = "too few samples for the fit";
+        return false;
+    }
+
+    // Cholesky factorization L L' of the regressors covariance, normalized
+    // by its diagonal so that the test on the pivots does not depend on
+    // the units of the regressors
+    size_t m = regressors;
+    for(size_t j=0; j<m; j++) {
+        if(!(cxx[j*m + j] > 0.0)) {
+            error = "regressor " + std::to_string(j) + " is constant";
+            return false;
+        }
+    }
+    for(size_t i=0; i<m; i++) {
+        for(size_t j=0; j<=i; j++) {
+            double s = cxx[j*m + i] / sqrt(cxx[i*m + i] * cxx[j*m + j]);
+            for(size_t k=0; k<j; k++)
+                s -= chol[i*m + k] * chol[j*m + k];
+            if(i == j) {
+                // 1 - s is the squared correlation of the regressor with
+                // the previous ones
+                if(s < 1e-8) {
+                    error = "regressor " + std::to_string(i) + " is not independent of the previous ones";
+                    return false;
+                }
+                chol[i*m + i] = sqrt(s);
+            }
+            else
+                chol[i*m + j] = s / chol[j*m + j];
+        }
+    }
+
+    double n = (double)samples;
+    for(size_t k=0; k<outputs; k++) {
+        double* a = &coeffs[k*m];
+        // forward and backward substitution on the normalized system
+        for(size_t i=0; i<m; i++) {
+            double s = cxy[i*outputs + k] / sqrt(cxx[i*m + i]);
+            for(size_t j=0; j<i; j++)
+                s -= chol[i*m + j] * a[j];
+            a[i] = s / chol[i*m + i];
+        }
+        for(size_t i=m; i-- > 0;) {
+            double s = a[i];
+            for(size_t j=i+1; j<m; j++)
+                s -= chol[j*m + i] * a[j];
+            a[i] = s / chol[i*m + i];
+        }
+        // back to the units of the regressors; the residual sum of squares
+        // at the optimum is Cyy - a' Cxy
+        double sse = cyy[k];
+        double b = mean_y[k];
+        for(size_t j=0; j<m; j++) {
+            a[j] /= sqrt(cxx[j*m + j]);
+            sse -= a[j] * cxy[j*outputs + k];
+            b -= a[j] * mean_x[j];
+        }
+        intercepts[k] = b;
+        residuals[k] = sqrt(std::max(sse, 0.0) / n);
+    }
+    return true;
+}
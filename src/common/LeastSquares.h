@@ -0,0 +1,87 @@
+/*
+ * iCub Robot Unit Tests (Robot Testing Framework)
+ *
+ * Copyright (C) 2015-2019 Istituto Italiano di Tecnologia (IIT)
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+#ifndef _LEASTSQUARES_H_
+#define _LEASTSQUARES_H_
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+/**
+ * Linear least-squares fit y = A x + b of several outputs on the same
+ * regressors, with an intercept b per output.
+ *
+ * The samples are not stored: add() updates the means and the centered
+ * second moments of the regressors and the outputs (Welford's update), so
+ * the memory does not depend on the number of samples and the fit does not
+ * suffer from the large offsets of the encoders. solve() then solves the
+ * normal equations with a Cholesky factorization.
+ *
+ * With no regressors the fit reduces to the mean of each output, and the
+ * residual to its standard deviation.
+ */
+class LeastSquares {
+public:
+    LeastSquares(size_t regressors=1, size_t outputs=1);
+
+    void configure(size_t regressors, size_t outputs);
+    void clear();
+
+    /** Adds a sample: the regressors x and the outputs y. */
+    void add(const double* x, const double* y);
+
+    size_t count() const { return samples; }
+
+    /**
+     * Fits the samples added so far.
+     * @return false if there are too few samples or if the regressors are
+     * (almost) linearly dependent, i.e. the samples do not excite them
+     * independently; getError() tells which one.
+     */
+    bool solve();
+
+    /** The coefficient of regressor j in output i, after solve(). */
+    double coefficient(size_t i, size_t j) const { return coeffs[i*regressors + j]; }
+    double intercept(size_t i) const { return intercepts[i]; }
+
+    /** The rms of the residuals of output i, after solve(). */
+    double residual(size_t i) const { return residuals[i]; }
+
+    std::string getError() const { return error; }
+
+private:
+    size_t regressors;
+    size_t outputs;
+    size_t samples;
+    std::vector<double> mean_x;
+    std::vector<double> mean_y;
+    std::vector<double> cxx;    // regressors x regressors, upper triangle
+    std::vector<double> cxy;    // regressors x outputs
+    std::vector<double> cyy;    // outputs
+    std::vector<double> dx;
+    std::vector<double> chol;
+    std::vector<double> coeffs;
+    std::vector<double> intercepts;
+    std::vector<double> residuals;
+    std::string error;
+};
+
+#endif //_LEASTSQUARES_H_
@@ -0,0 +1,250 @@
+/*
+ * iCub Robot Unit Tests (Robot Testing Framework)
+ *
+ * Copyright (C) 2015-2019 Istituto Italiano di Tecnologia (IIT)
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+#include <chrono>
+#include <algorithm>
+#include <yarp/os/Bottle.h>
+#include <yarp/os/Thread.h>
+#include <yarp/os/Time.h>
+#include <robottestingframework/TestAssert.h>
+#include <robottestingframework/TestResult.h>
+#include <robottestingframework/TestListener.h>
+#include "MultiPartTestCase.h"
+
+using namespace yarp::os;
+using namespace robottestingframework;
+
+
+// Collects the messages of the test of a part and posts them to the
+// thread which runs the multi-part test, the only one which reports
+class MultiPartTestCase::PartListener : public TestListener {
+public:
+    PartListener(MultiPartTestCase& owner, const std::string& part) : owner(owner), part(part) { }
+
+    virtual void addReport(const Test* test, TestMessage msg) { owner.post(part, "report", text(msg)); }
+    virtual void addError(const Test* test, TestMessage msg) { owner.post(part, "error", text(msg)); }
+    virtual void addFailure(const Test* test, TestMessage msg) { owner.post(part, "failure", text(msg)); }
+
+private:
+    static std::string text(const TestMessage& msg) {
+        return msg.getDetail().empty() ? msg.getMessage() : msg.getDetail();
+    }
+
+    MultiPartTestCase& owner;
+    std::string part;
+};
+
+
+// Runs the test of a part, with its own result, in its own thread
+class MultiPartTestCase::PartWorker : public Thread {
+public:
+    PartWorker(MultiPartTestCase& owner, MultiPartTestCase* test, const std::string& part) :
+        passed(false), duration(0.0), owner(owner), test(test), listener(owner, part) { }
+
+    virtual void run() {
+        double start = Time::now();
+        result.addListener(&listener);
+        robottestingframework::TestCase* testCase = test;
+        testCase->run(result);
+        passed = test->succeeded();
+        duration = Time::now() - start;
+        owner.finished();
+    }
+
+    bool passed;
+    double duration;
+
+private:
+    MultiPartTestCase& owner;
+    MultiPartTestCase* test;
+    PartListener listener;
+    TestResult result;
+};
+
+
+// The value of a (key value ...) entry: a flag without value is true, and
+// several values are kept together as a list
+static Value entryValue(const Bottle& entry) {
+    if(entry.size() == 1)
+        return Value(1);
+    if(entry.size() == 2)
+        return entry.get(1);
+    Value* list = Value::makeList();
+    list->asList()->append(entry.tail());
+    Value value(*list);
+    delete list;
+    return value;
+}
+
+
+MultiPartTestCase::MultiPartTestCase(std::string name) :
+    yarp::robottestingframework::TestCase(name), running(0) {
+}
+
+MultiPartTestCase::~MultiPartTestCase() { }
+
+bool MultiPartTestCase::setupParts(yarp::os::Property& property) {
+    if(property.check("name"))
+        setName(property.find("name").asString());
+
+    Bottle* partsBottle = property.find("parts").asList();
+    ROBOTTESTINGFRAMEWORK_ASSERT_ERROR_IF_FALSE(partsBottle!=0 && partsBottle->size()>0, "unable to parse parts parameter");
+    parts.clear();
+    for(size_t i=0; i<partsBottle->size(); i++) {
+        std::string part = partsBottle->get(i).asString();
+        ROBOTTESTINGFRAMEWORK_ASSERT_ERROR_IF_FALSE(!part.empty() && std::find(parts.begin(), parts.end(), part) == parts.end(),
+                                                    "the parts must be distinct names");
+        parts.push_back(part);
+    }
+
+    // the common parameters, but the list of parts and the groups of the parts
+    Bottle common(property.toString());
+    partParams.clear();
+    for(size_t p=0; p<parts.size(); p++) {
+        Property params;
+        for(size_t i=0; i<common.size(); i++) {
+            Bottle* entry = common.get(i).asList();
+            if(!entry || entry->size() == 0)
+                continue;
+            std::string key = entry->get(0).asString();
+            if(key == "parts" || key == "from" || key == "name" ||
+               std::find(parts.begin(), parts.end(), key) != parts.end())
+                continue;
+            params.put(key, entryValue(*entry));
+        }
+        // the group of the part, e.g. --left_arm::joints "(0 1 2)"
+        Bottle& group = property.findGroup(parts[p]);
+        for(size_t i=1; i<group.size(); i++) {
+            Bottle* entry = group.get(i).asList();
+            if(entry && entry->size() > 1)
+                params.put(entry->get(0).asString(), entryValue(*entry));
+        }
+        params.put("part", parts[p]);
+        params.put("name", getName() + "/" + parts[p]);
+
+        // back to the command line the test of the part is set up from
+        std::string line;
+        Bottle all(params.toString());
+        for(size_t i=0; i<all.size(); i++) {
+            Bottle* entry = all.get(i).asList();
+            if(!entry || entry->size() < 2)
+                continue;
+            line += " --" + entry->get(0).asString() + " \"" + entry->get(1).toString() + "\"";
+        }
+        partParams.push_back(line);
+    }
+    ROBOTTESTINGFRAMEWORK_TEST_REPORT(Asserter::format("running on %d parts at the same time", (int)parts.size()));
+    return true;
+}
+
+void MultiPartTestCase::post(const std::string& part, const std::string& kind, const std::string& text) {
+    std::lock_guard<std::mutex> guard(messagesMutex);
+    PartMessage msg;
+    msg.part = part;
+    msg.kind = kind;
+    msg.text = text;
+    messages.push_back(msg);
+    messagesReady.notify_one();
+}
+
+void MultiPartTestCase::finished() {
+    std::lock_guard<std::mutex> guard(messagesMutex);
+    running--;
+    messagesReady.notify_one();
+}
+
+void MultiPartTestCase::interruptParts() {
+    std::lock_guard<std::mutex> guard(partsMutex);
+    for(size_t i=0; i<partTests.size(); i++)
+        partTests[i]->interrupt();
+}
+
+void MultiPartTestCase::interrupt() {
+    yarp::robottestingframework::TestCase::interrupt();
+    interruptParts();
+}
+
+void MultiPartTestCase::runParts() {
+    std::vector<PartWorker*> workers;
+    {
+        std::lock_guard<std::mutex> guard(partsMutex);
+        for(size_t p=0; p<parts.size(); p++) {
+            MultiPartTestCase* test = createPartTest();
+            test->setParam(partParams[p]);
+            partTests.push_back(test);
+            workers.push_back(new PartWorker(*this, test, parts[p]));
+        }
+    }
+    running = workers.size();
+    double start = Time::now();
+    for(size_t p=0; p<workers.size(); p++) {
+        if(!workers[p]->start()) {
+            post(parts[p], "error", "unable to start the thread of the part");
+            finished();
+        }
+    }
+
+    // forward the messages of the parts as they come, until all of them are done
+    bool stopped = false;
+    bool done = false;
+    while(!done) {
+        std::deque<PartMessage> pending;
+        {
+            std::unique_lock<std::mutex> lock(messagesMutex);
+            messagesReady.wait_for(lock, std::chrono::milliseconds(100),
+                                   [this]{ return !messages.empty() || running == 0; });
+            pending.swap(messages);
+            done = (running == 0);
+        }
+        for(size_t i=0; i<pending.size(); i++) {
+            const PartMessage& msg = pending[i];
+            std::string text = "[" + msg.part + "] " + msg.text;
+            if(msg.kind == "report") {
+                ROBOTTESTINGFRAMEWORK_TEST_REPORT(text);
+                continue;
+            }
+            ROBOTTESTINGFRAMEWORK_TEST_CHECK(false, msg.kind == "error" ? text + " (error)" : text);
+            if(msg.kind == "error" && !stopped) {
+                ROBOTTESTINGFRAMEWORK_TEST_REPORT("Safety stop: interrupting all the parts after an error on " + msg.part);
+                stopped = true;
+                interruptParts();
+            }
+        }
+    }
+    double duration = Time::now() - start;
+
+    double sequential = 0.0;
+    for(size_t p=0; p<workers.size(); p++) {
+        workers[p]->join();
+        sequential += workers[p]->duration;
+        ROBOTTESTINGFRAMEWORK_TEST_CHECK(workers[p]->passed, Asserter::format("%s %s in %.1f s", parts[p].c_str(),
+                                                                              workers[p]->passed ? "passed" : "failed",
+                                                                              workers[p]->duration));
+    }
+    ROBOTTESTINGFRAMEWORK_TEST_REPORT(Asserter::format("%d parts tested in %.1f s (%.1f s one after the other)",
+                                                       (int)parts.size(), duration, sequential));
+
+    std::lock_guard<std::mutex> guard(partsMutex);
+    for(size_t p=0; p<workers.size(); p++) {
+        delete workers[p];
+        delete partTests[p];
+    }
+    partTests.clear();
+}
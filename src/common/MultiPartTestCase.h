@@ -0,0 +1,103 @@
+/*
+ * iCub Robot Unit Tests (Robot Testing Framework)
+ *
+ * Copyright (C) 2015-2019 Istituto Italiano di Tecnologia (IIT)
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+#ifndef _MULTIPARTTESTCASE_H_
+#define _MULTIPARTTESTCASE_H_
+
+#include <string>
+#include <vector>
+#include <deque>
+#include <mutex>
+#include <condition_variable>
+#include <yarp/os/Property.h>
+#include <yarp/robottestingframework/TestCase.h>
+
+/**
+ * A test case which can run the same test on several parts of the robot at
+ * the same time, instead of one part per plugin run.
+ *
+ * When the parameters contain the list of parts, e.g.
+ *
+ *     --parts "(left_arm right_arm)" --robot icub --tolerance 0.2
+ *     --left_arm::joints "(0 1 2)" --left_arm::home "(0 20 0)" ...
+ *     --right_arm::joints "(0 1 2)" ...
+ *
+ * setupParts() prepares the parameters of each part: the common ones, the
+ * part name and the (key value) entries of the group named after the part,
+ * which override the common ones. runParts() then
+ * creates an instance of the test for each part (createPartTest()) and runs
+ * it, with its own driver, in its own thread, so the run takes as long as
+ * the slowest part rather than the sum of all of them.
+ *
+ * The instances report to their own results, which are forwarded as they
+ * come, prefixed by the part, and summed up per part at the end. An error
+ * in any part is a safety stop for all of them: the other parts are
+ * interrupted, so that they stop their joints and abort.
+ *
+ * A test using it checks multiPart() in setup(), run() and tearDown(), and
+ * stops its joints in interrupt() (e.g. ControlBoardHelper::interrupt()),
+ * calling MultiPartTestCase::interrupt() as well.
+ */
+class MultiPartTestCase : public yarp::robottestingframework::TestCase {
+public:
+    MultiPartTestCase(std::string name);
+    virtual ~MultiPartTestCase();
+
+    /** Interrupts all the parts which are running. */
+    virtual void interrupt();
+
+protected:
+    /** A new instance of the test, to be run on a single part. */
+    virtual MultiPartTestCase* createPartTest() = 0;
+
+    bool multiPart() const { return !parts.empty(); }
+
+    /** Parses the list of parts and prepares the parameters of each one. */
+    bool setupParts(yarp::os::Property& property);
+
+    /** Runs the test on all the parts at the same time and waits for them. */
+    void runParts();
+
+private:
+    struct PartMessage {
+        std::string part;
+        std::string kind;
+        std::string text;
+    };
+
+    class PartListener;
+    class PartWorker;
+
+    void post(const std::string& part, const std::string& kind, const std::string& text);
+    void finished();
+    void interruptParts();
+
+private:
+    std::vector<std::string> parts;
+    std::vector<std::string> partParams;
+    std::vector<MultiPartTestCase*> partTests;
+    std::mutex partsMutex;
+    std::mutex messagesMutex;
+    std::condition_variable messagesReady;
+    std::deque<PartMessage> messages;
+    size_t running;
+};
+
+#endif //_MULTIPARTTESTCASE_H_
@@ -0,0 +1,66 @@
+/*
+ * iCub Robot Unit Tests (Robot Testing Framework)
+ *
+ * Copyright (C) 2015-2019 Istituto Italiano di Tecnologia (IIT)
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+#ifndef _RINGBUFFER_H_
+#define _RINGBUFFER_H_
+
+#include <cstddef>
+#include <vector>
+
+/**
+ * A fixed-capacity circular buffer: once full, every push() overwrites
+ * the oldest element, so the memory never grows.
+ */
+template <class T>
+class RingBuffer {
+public:
+    RingBuffer(size_t capacity=1) : data(capacity>0 ? capacity : 1), head(0), count(0) { }
+
+    void setCapacity(size_t capacity) {
+        data.assign(capacity>0 ? capacity : 1, T());
+        clear();
+    }
+
+    void clear() { head = count = 0; }
+
+    void push(const T& item) {
+        data[head] = item;
+        head = (head+1) % data.size();
+        count = (count < data.size()) ? count+1 : count;
+    }
+
+    size_t size() const { return count; }
+    size_t capacity() const { return data.size(); }
+    bool empty() const { return count == 0; }
+
+    /** i=0 is the oldest element, i=size()-1 the newest one. */
+    const T& operator[](size_t i) const {
+        return data[(head + data.size() - count + i) % data.size()];
+    }
+
+    const T& back() const { return (*this)[count-1]; }
+
+private:
+    std::vector<T> data;
+    size_t head;
+    size_t count;
+};
+
+#endif //_RINGBUFFER_H_
@@ -0,0 +1,130 @@
+/*
+ * iCub Robot Unit Tests (Robot Testing Framework)
+ *
+ * Copyright (C) 2015-2019 Istituto Italiano di Tecnologia (IIT)
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+#include <math.h>
+#include <algorithm>
+#include "SavitzkyGolay.h"
+
+SavitzkyGolay::SavitzkyGolay(size_t window, unsigned int degree, size_t channels) {
+    if(!configure(window, degree, channels))
+        configure(9, 2, channels);
+}
+
+bool SavitzkyGolay::configure(size_t window, unsigned int degree, size_t channels) {
+    if(window % 2 == 0 || window <= degree || degree < 1 || channels == 0)
+        return false;
+    this->window = window;
+    this->degree = degree;
+    this->channels = channels;
+    times.resize(window);
+    values.resize(window*channels);
+    weights.resize(window);
+    normal.resize((degree+1)*(degree+2));
+    clear();
+    return true;
+}
+
+void SavitzkyGolay::clear() {
+    head = count = 0;
+}
+
+void SavitzkyGolay::push(double time, const double* v) {
+    times[head] = time;
+    std::copy(v, v+channels, values.begin() + head*channels);
+    head = (head+1) % window;
+    count = std::min(count+1, window);
+}
+
+double SavitzkyGolay::centerTime() const {
+    return times[index(count/2)];
+}
+
+void SavitzkyGolay::center(double* v) const {
+    size_t c = index(count/2);
+    std::copy(values.begin() + c*channels, values.begin() + (c+1)*channels, v);
+}
+
+bool SavitzkyGolay::derivative(double* derivatives, size_t n) {
+    if(!ready())
+        return false;
+    n = (n == 0 || n > channels) ? channels : n;
+
+    // local time, scaled by the span of the window for a well conditioned fit
+    double tc = centerTime();
+    double scale = (times[index(window-1)] - times[index(0)]) / 2.0;
+    if(!(scale > 0.0))
+        return false;
+
+    // normal equations (A'A) z = e1 of the fit, with A(k,j) = tau_k^j;
+    // stored as an augmented (degree+1) x (degree+2) matrix
+    size_t m = degree + 1;
+    std::fill(normal.begin(), normal.end(), 0.0);
+    for(size_t k=0; k<window; k++) {
+        double tau = (times[index(k)] - tc) / scale;
+        double pi = 1.0;
+        for(size_t i=0; i<m; i++, pi *= tau) {
+            double pj = pi * pi;
+            for(size_t j=i; j<m; j++, pj *= tau)
+                normal[i*(m+1) + j] += pj;
+        }
+    }
+    for(size_t i=0; i<m; i++) {
+        for(size_t j=0; j<i; j++)
+            normal[i*(m+1) + j] = normal[j*(m+1) + i];
+        normal[i*(m+1) + m] = (i == 1) ? 1.0 : 0.0;
+    }
+
+    // Gaussian elimination with partial pivoting
+    for(size_t c=0; c<m; c++) {
+        size_t pivot = c;
+        for(size_t r=c+1; r<m; r++)
+            if(fabs(normal[r*(m+1) + c]) > fabs(normal[pivot*(m+1) + c]))
+                pivot = r;
+        if(fabs(normal[pivot*(m+1) + c]) < 1e-12)
+            return false;
+        for(size_t j=0; j<=m; j++)
+            std::swap(normal[c*(m+1) + j], normal[pivot*(m+1) + j]);
+        for(size_t r=0; r<m; r++) {
+            if(r == c)
+                continue;
+            double f = normal[r*(m+1) + c] / normal[c*(m+1) + c];
+            for(size_t j=c; j<=m; j++)
+                normal[r*(m+1) + j] -= f * normal[c*(m+1) + j];
+        }
+    }
+
+    // the weight of each sample: z' phi(tau_k), in units of 1/time
+    for(size_t k=0; k<window; k++) {
+        double tau = (times[index(k)] - tc) / scale;
+        double pi = 1.0, w = 0.0;
+        for(size_t i=0; i<m; i++, pi *= tau)
+            w += normal[i*(m+1) + m] / normal[i*(m+1) + i] * pi;
+        weights[k] = w / scale;
+    }
+
+    std::fill(derivatives, derivatives+n, 0.0);
+    for(size_t k=0; k<window; k++) {
+        const double* row = &values[index(k)*channels];
+        double w = weights[k];
+        for(size_t c=0; c<n; c++)
+            derivatives[c] += w * row[c];
+    }
+    return true;
+}
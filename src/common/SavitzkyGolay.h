@@ -0,0 +1,81 @@
+/*
+ * iCub Robot Unit Tests (Robot Testing Framework)
+ *
+ * Copyright (C) 2015-2019 Istituto Italiano di Tecnologia (IIT)
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+#ifndef _SAVITZKYGOLAY_H_
+#define _SAVITZKYGOLAY_H_
+
+#include <cstddef>
+#include <vector>
+
+/**
+ * Savitzky-Golay differentiator over a sliding window of timestamped
+ * samples of several channels.
+ *
+ * A polynomial of the given degree is fitted (least squares) to the samples
+ * of the window around its central sample, and its derivative there is the
+ * estimated rate of change. The fit uses the actual timestamps, so the
+ * samples need not be evenly spaced. The weights depend on the timestamps
+ * only: they are computed once per window and applied to all the channels.
+ *
+ * The derivative refers to the central sample, i.e. it is delayed by half
+ * a window: center() gives the samples it must be compared with.
+ */
+class SavitzkyGolay {
+public:
+    SavitzkyGolay(size_t window=9, unsigned int degree=2, size_t channels=1);
+
+    /** The window (odd, > degree) and the degree of the polynomial. */
+    bool configure(size_t window, unsigned int degree, size_t channels);
+    void clear();
+
+    /** Adds a sample of all the channels, dropping the oldest one. */
+    void push(double time, const double* values);
+
+    bool ready() const { return count == window; }
+
+    /** The time of the central sample of the window. */
+    double centerTime() const;
+
+    /** Copies the values of the central sample. */
+    void center(double* values) const;
+
+    /**
+     * Computes the first derivative of the first n channels (all of them
+     * if n is 0) at the central sample.
+     * @return false until the window is full or if its timestamps coincide
+     */
+    bool derivative(double* derivatives, size_t n=0);
+
+private:
+    size_t index(size_t i) const { return (head + window - count + i) % window; }
+
+private:
+    size_t window;
+    unsigned int degree;
+    size_t channels;
+    size_t head;
+    size_t count;
+    std::vector<double> times;
+    std::vector<double> values;
+    std::vector<double> weights;
+    std::vector<double> normal;
+};
+
+#endif //_SAVITZKYGOLAY_H_
@@ -0,0 +1,159 @@
+/*
+ * iCub Robot Unit Tests (Robot Testing Framework)
+ *
+ * Copyright (C) 2015-2019 Istituto Italiano di Tecnologia (IIT)
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+#include <cstdio>
+#include "SequenceAnalyzer.h"
+
+#define WINDOW  64
+
+SequenceAnalyzer::SequenceAnalyzer(unsigned int maxBurst, int64_t period) :
+    period(period), bursts(maxBurst>0 ? maxBurst : 1) {
+    reset();
+}
+
+void SequenceAnalyzer::reset() {
+    started = false;
+    highest = 0;
+    received = 0;
+    beyond = 0;
+    stalePending = false;
+    staleSequence = 0;
+    resetCounters();
+}
+
+void SequenceAnalyzer::resetCounters() {
+    lost = reordered = repeated = stale = wraps = restarts = 0;
+    maxBurstSeen = 0;
+    for(size_t i=0; i<bursts.size(); i++)
+        bursts[i] = 0;
+}
+
+void SequenceAnalyzer::add(int64_t sequence) {
+    if(!started) {
+        started = true;
+        restart(sequence);
+        return;
+    }
+
+    // a stale message followed by the next one: the sender restarted from it
+    if(stalePending) {
+        stalePending = false;
+        if(sequence == (staleSequence+1) % period) {
+            stale--;
+            restarts++;
+            restart(sequence);
+            return;
+        }
+    }
+
+    int64_t delta = sequence - highest;
+    // the counter wrapped around: bring it back to a small positive step
+    bool wrapped = (delta < -period/2);
+    if(wrapped)
+        delta += period;
+
+    if(delta > 0) {
+        if(wrapped)
+            wraps++;
+        int64_t gap = delta - 1;
+        if(gap > 0) {
+            lost += gap;
+            countBurst(gap, true);
+            maxBurstSeen = ((unsigned long)gap > maxBurstSeen) ? gap : maxBurstSeen;
+        }
+        // shift the window: the previous highest becomes bit delta-1
+        if(delta <= WINDOW) {
+            // keep the length of the run of missing messages leaving the window
+            int64_t run = 0;
+            while(run < delta && !(received & ((uint64_t)1 << (WINDOW-delta+run))))
+                run++;
+            beyond = (run == delta) ? beyond + delta : run;
+            received = (delta < WINDOW) ? received << delta : 0;
+            received |= (uint64_t)1 << (delta-1);
+        }
+        else {
+            beyond = delta - 1 - WINDOW;
+            received = 0;
+        }
+        highest = sequence;
+    }
+    else if(delta == 0) {
+        repeated++;
+    }
+    else if(-delta <= WINDOW) {
+        uint64_t bit = (uint64_t)1 << (-delta-1);
+        if(received & bit)
+            repeated++;
+        else {
+            // the message splits the burst it belonged to
+            int64_t pos = -delta-1;
+            int64_t lo = pos, hi = pos;
+            while(lo > 0 && !(received & ((uint64_t)1 << (lo-1))))
+                lo--;
+            while(hi < WINDOW-1 && !(received & ((uint64_t)1 << (hi+1))))
+                hi++;
+            int64_t older = hi - pos + ((hi == WINDOW-1) ? beyond : 0);
+            countBurst(pos - lo + 1 + older, false);
+            countBurst(pos - lo, true);
+            countBurst(older, true);
+            received |= bit;
+            reordered++;
+            lost = (lost > 0) ? lost-1 : 0;
+        }
+    }
+    else {
+        // far in the past: a late or repeated message, unless the next one
+        // continues from it
+        stale++;
+        stalePending = true;
+        staleSequence = sequence;
+    }
+}
+
+void SequenceAnalyzer::restart(int64_t sequence) {
+    highest = sequence;
+    received = ~((uint64_t)0);          // nothing before it is missing
+    beyond = 0;
+}
+
+void SequenceAnalyzer::countBurst(int64_t length, bool add) {
+    if(length <= 0)
+        return;
+    size_t bin = (length <= (int64_t)bursts.size()) ? length-1 : bursts.size()-1;
+    if(add)
+        bursts[bin]++;
+    else if(bursts[bin] > 0)
+        bursts[bin]--;
+}
+
+std::string SequenceAnalyzer::burstsToString() const {
+    std::string str;
+    char buf[64];
+    for(size_t i=0; i<bursts.size(); i++) {
+        if(bursts[i] == 0)
+            continue;
+        if(i+1 < bursts.size())
+            snprintf(buf, sizeof(buf), "%s%lu:%lu", str.empty() ? "" : " ", (unsigned long)(i+1), bursts[i]);
+        else
+            snprintf(buf, sizeof(buf), "%s>=%lu:%lu", str.empty() ? "" : " ", (unsigned long)(i+1), bursts[i]);
+        str += buf;
+    }
+    return str.empty() ? "none" : str;
+}
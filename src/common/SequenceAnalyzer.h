@@ -0,0 +1,94 @@
+/*
+ * iCub Robot Unit Tests (Robot Testing Framework)
+ *
+ * Copyright (C) 2015-2019 Istituto Italiano di Tecnologia (IIT)
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+#ifndef _SEQUENCEANALYZER_H_
+#define _SEQUENCEANALYZER_H_
+
+#include <vector>
+#include <string>
+#include <stdint.h>
+
+/**
+ * Analyzes the sequence numbers of a stream (e.g. the count of the
+ * yarp::os::Stamp envelopes): lost messages grouped in bursts, reordered
+ * and repeated messages, wrap-around and restarts of the counter.
+ *
+ * The state is a bitmap of the last 64 sequence numbers below the highest
+ * one received, so the cost per message is constant. A message older than
+ * this window is counted as stale (a late or repeated one, which cannot be
+ * told apart) and considered a restart of the sender only when the next
+ * message continues from it.
+ * A message arriving after a newer one fills the hole it left: it is counted
+ * as reordered and no longer as lost, and the burst it belonged to is
+ * replaced by the (up to two) shorter bursts left around it.
+ */
+class SequenceAnalyzer {
+public:
+    /**
+     * @param maxBurst the number of bins of the histogram of the bursts
+     * @param period the counter wraps to 0 after period-1 (yarp::os::Stamp
+     * wraps after getMaxCount())
+     */
+    SequenceAnalyzer(unsigned int maxBurst=16, int64_t period=32768);
+
+    /** Forgets everything. */
+    void reset();
+
+    /** Resets the counters, but keeps tracking the sequence. */
+    void resetCounters();
+
+    void add(int64_t sequence);
+
+    unsigned long getLost() const { return lost; }
+    unsigned long getReordered() const { return reordered; }
+    unsigned long getRepeated() const { return repeated; }
+    unsigned long getStale() const { return stale; }
+    unsigned long getWraps() const { return wraps; }
+    unsigned long getRestarts() const { return restarts; }
+    /** The longest gap seen, not revised by the messages arriving late. */
+    unsigned long getMaxBurst() const { return maxBurstSeen; }
+
+    /**
+     * The number of loss bursts by length: element i counts the bursts of
+     * i+1 consecutive lost messages, the last one all the longer bursts.
+     */
+    const std::vector<unsigned long>& getBursts() const { return bursts; }
+
+    /** A compact description of the bursts, e.g. "1:12 2:3 >=16:1". */
+    std::string burstsToString() const;
+
+private:
+    void countBurst(int64_t length, bool add);
+    void restart(int64_t sequence);
+
+private:
+    int64_t period;
+    std::vector<unsigned long> bursts;
+    bool started;
+    int64_t highest;
+    uint64_t received;          // bit i: highest-1-i has been received
+    int64_t beyond;             // missing messages just older than the window
+    bool stalePending;          // the last message was stale: maybe a restart
+    int64_t staleSequence;
+    unsigned long lost, reordered, repeated, stale, wraps, restarts;
+    unsigned long maxBurstSeen;
+};
+
+#endif //_SEQUENCEANALYZER_H_
@@ -0,0 +1,310 @@
+/*
+ * iCub Robot Unit Tests (Robot Testing Framework)
+ *
+ * Copyright (C) 2015-2019 Istituto Italiano di Tecnologia (IIT)
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+#include <cstring>
+#include <fstream>
+#include <sstream>
+#include <stdint.h>
+#include "Telemetry.h"
+
+#if !defined(_WIN32)
+    #include <fcntl.h>
+    #include <unistd.h>
+    #include <sys/mman.h>
+    #include <sys/stat.h>
+#endif
+
+static size_t padding(size_t size) {
+    return (8 - size % 8) % 8;
+}
+
+
+TelemetryRecorder::TelemetryRecorder() :
+    file(NULL), channels(0), blockRows(0), filled(0), rows(0) {
+}
+
+TelemetryRecorder::~TelemetryRecorder() {
+    close();
+}
+
+bool TelemetryRecorder::open(const std::string& filename, const std::vector<std::string>& channels,
+                             size_t blockRows) {
+    close();
+    if(channels.empty() || blockRows == 0) {
+        error = "at least one channel and one row per block are needed";
+        return false;
+    }
+    file = fopen(filename.c_str(), "wb");
+    if(!file) {
+        error = "unable to create " + filename;
+        return false;
+    }
+    this->channels = channels.size();
+    this->blockRows = blockRows;
+    filled = rows = 0;
+    block.assign(this->channels * blockRows, 0.0);
+
+    // the header
+    std::string header(TELEMETRY_MAGIC);
+    uint32_t n = (uint32_t)channels.size();
+    header.append((const char*)&n, sizeof(n));
+    for(size_t i=0; i<channels.size(); i++) {
+        uint32_t length = (uint32_t)channels[i].size();
+        header.append((const char*)&length, sizeof(length));
+        header.append(channels[i]);
+    }
+    header.append(padding(header.size()), '\0');
+    if(fwrite(header.data(), 1, header.size(), file) != header.size()) {
+        error = "unable to write " + filename;
+        fclose(file);
+        file = NULL;
+        return false;
+    }
+    return true;
+}
+
+void TelemetryRecorder::set(size_t firstChannel, const double* values, size_t n) {
+    for(size_t i=0; i<n; i++)
+        block[(firstChannel+i)*blockRows + filled] = values[i];
+}
+
+bool TelemetryRecorder::commit() {
+    if(!file) {
+        error = "not open";
+        return false;
+    }
+    filled++;
+    rows++;
+    return (filled < blockRows) ? true : flush();
+}
+
+bool TelemetryRecorder::append(const double* values) {
+    if(!file) {
+        error = "not open";
+        return false;
+    }
+    set(0, values, channels);
+    return commit();
+}
+
+bool TelemetryRecorder::flush() {
+    if(!file) {
+        error = "not open";
+        return false;
+    }
+    if(filled == 0)
+        return true;
+    uint32_t header[2] = { (uint32_t)filled, 0 };
+    bool ok = (fwrite(header, sizeof(header), 1, file) == 1);
+    // a partial block is written channel by channel, a full one at once
+    if(filled == blockRows)
+        ok = ok && (fwrite(block.data(), sizeof(double), block.size(), file) == block.size());
+    else {
+        for(size_t c=0; c<channels && ok; c++)
+            ok = (fwrite(&block[c*blockRows], sizeof(double), filled, file) == filled);
+    }
+    ok = ok && (fflush(file) == 0);
+    filled = 0;
+    if(!ok)
+        error = "unable to write the telemetry file";
+    return ok;
+}
+
+bool TelemetryRecorder::close() {
+    if(!file)
+        return true;
+    bool ok = flush();
+    ok = (fclose(file) == 0) && ok;
+    file = NULL;
+    block.clear();
+    block.shrink_to_fit();
+    return ok;
+}
+
+std::vector<std::string> TelemetryRecorder::channelNames(const std::string& prefix, size_t n) {
+    std::vector<std::string> names;
+    for(size_t i=0; i<n; i++) {
+        std::ostringstream name;
+        name << prefix << i;
+        names.push_back(name.str());
+    }
+    return names;
+}
+
+
+TelemetryReader::TelemetryReader() :
+    data(NULL), size(0), mapped(false), rows(0) {
+}
+
+TelemetryReader::~TelemetryReader() {
+    close();
+}
+
+bool TelemetryReader::open(const std::string& filename) {
+    close();
+#if !defined(_WIN32)
+    int fd = ::open(filename.c_str(), O_RDONLY);
+    if(fd < 0) {
+        error = "unable to open " + filename;
+        return false;
+    }
+    struct stat st;
+    if(fstat(fd, &st) == 0 && st.st_size > 0) {
+        void* p = mmap(NULL, (size_t)st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+        if(p != MAP_FAILED) {
+            data = (const char*)p;
+            size = (size_t)st.st_size;
+            mapped = true;
+        }
+    }
+    ::close(fd);
+#endif
+    if(!mapped) {
+        std::ifstream in(filename.c_str(), std::ios::binary);
+        if(!in.is_open()) {
+            error = "unable to open " + filename;
+            return false;
+        }
+        buffer.assign(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+        data = buffer.data();
+        size = buffer.size();
+    }
+
+    // the header
+    size_t magic = strlen(TELEMETRY_MAGIC);
+    uint32_t n = 0;
+    if(size < magic + sizeof(n) || memcmp(data, TELEMETRY_MAGIC, magic) != 0) {
+        error = filename + " is not a telemetry file";
+        close();
+        return false;
+    }
+    size_t offset = magic;
+    memcpy(&n, data+offset, sizeof(n));
+    offset += sizeof(n);
+    for(uint32_t i=0; i<n; i++) {
+        uint32_t length = 0;
+        if(offset + sizeof(length) > size) {
+            error = filename + " has a truncated header";
+            close();
+            return false;
+        }
+        memcpy(&length, data+offset, sizeof(length));
+        offset += sizeof(length);
+        if(offset + length > size) {
+            error = filename + " has a truncated header";
+            close();
+            return false;
+        }
+        names.push_back(std::string(data+offset, length));
+        offset += length;
+    }
+    offset += padding(offset);
+
+    // the blocks; an incomplete last block is ignored
+    while(offset + 2*sizeof(uint32_t) <= size) {
+        uint32_t header[2];
+        memcpy(header, data+offset, sizeof(header));
+        size_t bytes = (size_t)header[0] * names.size() * sizeof(double);
+        if(offset + sizeof(header) + bytes > size)
+            break;
+        Block b = { rows, header[0], data + offset + sizeof(header) };
+        blocks.push_back(b);
+        rows += header[0];
+        offset += sizeof(header) + bytes;
+    }
+    return true;
+}
+
+void TelemetryReader::close() {
+#if !defined(_WIN32)
+    if(mapped)
+        munmap((void*)data, size);
+#endif
+    data = NULL;
+    size = 0;
+    mapped = false;
+    buffer.clear();
+    names.clear();
+    blocks.clear();
+    rows = 0;
+}
+
+int TelemetryReader::findChannel(const std::string& name) const {
+    for(size_t i=0; i<names.size(); i++)
+        if(names[i] == name)
+            return (int)i;
+    return -1;
+}
+
+bool TelemetryReader::getChannel(size_t channel, std::vector<double>& values) const {
+    if(channel >= names.size()) {
+        return false;
+    }
+    values.resize(rows);
+    for(size_t i=0; i<blocks.size(); i++)
+        memcpy(values.data() + blocks[i].firstRow,
+               blocks[i].data + channel*blocks[i].rows*sizeof(double),
+               blocks[i].rows*sizeof(double));
+    return true;
+}
+
+const TelemetryReader::Block* TelemetryReader::findBlock(size_t row) const {
+    // the blocks are sorted by row: binary search
+    size_t lo = 0, hi = blocks.size();
+    while(lo < hi) {
+        size_t mid = (lo + hi) / 2;
+        if(blocks[mid].firstRow + blocks[mid].rows <= row)
+            lo = mid + 1;
+        else
+            hi = mid;
+    }
+    return (lo < blocks.size()) ? &blocks[lo] : NULL;
+}
+
+double TelemetryReader::get(size_t row, size_t channel) const {
+    const Block* b = findBlock(row);
+    if(!b || channel >= names.size())
+        return 0.0;
+    double value;
+    memcpy(&value, b->data + (channel*b->rows + row - b->firstRow)*sizeof(double), sizeof(value));
+    return value;
+}
+
+bool TelemetryReader::exportText(const std::string& filename, char separator, bool header) const {
+    FILE* out = fopen(filename.c_str(), "w");
+    if(!out)
+        return false;
+    if(header) {
+        for(size_t c=0; c<names.size(); c++)
+            fprintf(out, "%s%c", names[c].c_str(), (c+1 < names.size()) ? separator : '\n');
+    }
+    for(size_t i=0; i<blocks.size(); i++) {
+        const Block& b = blocks[i];
+        for(size_t r=0; r<b.rows; r++) {
+            for(size_t c=0; c<names.size(); c++) {
+                double value;
+                memcpy(&value, b.data + (c*b.rows + r)*sizeof(double), sizeof(value));
+                // %.17g keeps the full precision of a double
+                fprintf(out, "%.17g%c", value, (c+1 < names.size()) ? separator : '\n');
+            }
+        }
+    }
+    return fclose(out) == 0;
+}
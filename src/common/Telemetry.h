@@ -0,0 +1,153 @@
+/*
+ * iCub Robot Unit Tests (Robot Testing Framework)
+ *
+ * Copyright (C) 2015-2019 Istituto Italiano di Tecnologia (IIT)
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+#ifndef _TELEMETRY_H_
+#define _TELEMETRY_H_
+
+#include <cstdio>
+#include <string>
+#include <vector>
+
+/**
+ * The telemetry file format: a header with the channel names followed by
+ * a sequence of blocks, each holding a number of rows stored channel by
+ * channel (i.e. column-major), as native (little-endian) doubles.
+ *
+ *  header: "ICUBTLM1", uint32 channels, { uint32 length, name }, padding to 8 bytes
+ *  block:  uint32 rows, uint32 reserved, double[channels][rows]
+ *
+ * The blocks are only appended, so a file truncated by a crash is still
+ * readable up to the last complete block.
+ */
+#define TELEMETRY_MAGIC         "ICUBTLM1"
+#define TELEMETRY_BLOCK_ROWS    4096
+
+/**
+ * Records rows of samples to a telemetry file.
+ *
+ * The rows are collected in a preallocated block, one array per channel,
+ * and each full block is written to the file with a single write: the
+ * memory used is constant however long the acquisition is, and the values
+ * are saved with their full precision.
+ *
+ * A row is either appended at once with append(), or filled piece by piece
+ * with set() and then committed with commit().
+ */
+class TelemetryRecorder {
+public:
+    TelemetryRecorder();
+    ~TelemetryRecorder();
+
+    /**
+     * Creates the file and writes the header.
+     * @param blockRows the number of rows kept in memory before writing them
+     */
+    bool open(const std::string& filename, const std::vector<std::string>& channels,
+              size_t blockRows=TELEMETRY_BLOCK_ROWS);
+    bool isOpen() const { return file != NULL; }
+
+    /** Sets the value of a channel in the row being filled. */
+    void set(size_t channel, double value) { block[channel*blockRows + filled] = value; }
+
+    /** Sets n consecutive channels in the row being filled. */
+    void set(size_t firstChannel, const double* values, size_t n);
+
+    /** Appends the row being filled. */
+    bool commit();
+
+    /** Appends a row with the values of all the channels. */
+    bool append(const double* values);
+
+    /** Writes the rows collected so far. */
+    bool flush();
+
+    /** Flushes and closes the file. */
+    bool close();
+
+    size_t getChannels() const { return channels; }
+    size_t getRows() const { return rows; }
+    std::string getError() const { return error; }
+
+    /** The names "prefix0", "prefix1", ... "prefix<n-1>". */
+    static std::vector<std::string> channelNames(const std::string& prefix, size_t n);
+
+private:
+    FILE* file;
+    size_t channels;
+    size_t blockRows;
+    size_t filled;
+    size_t rows;
+    std::vector<double> block;
+    std::string error;
+};
+
+/**
+ * Reads a telemetry file, memory-mapping it where possible so that only
+ * the accessed channels are actually loaded.
+ */
+class TelemetryReader {
+public:
+    TelemetryReader();
+    ~TelemetryReader();
+
+    bool open(const std::string& filename);
+    void close();
+
+    size_t getChannels() const { return names.size(); }
+    size_t getRows() const { return rows; }
+    const std::vector<std::string>& getChannelNames() const { return names; }
+
+    /** Returns the index of the channel with the given name or -1. */
+    int findChannel(const std::string& name) const;
+
+    /** Copies all the samples of a channel. */
+    bool getChannel(size_t channel, std::vector<double>& values) const;
+
+    double get(size_t row, size_t channel) const;
+
+    /**
+     * Exports the file as text, one line per row.
+     * @param separator e.g. ',' for CSV or ' ' for Octave's load()
+     * @param header whether the first line has the channel names
+     */
+    bool exportText(const std::string& filename, char separator=',', bool header=true) const;
+
+    std::string getError() const { return error; }
+
+private:
+    struct Block {
+        size_t firstRow;
+        size_t rows;
+        const char* data;
+    };
+    const Block* findBlock(size_t row) const;
+
+private:
+    const char* data;
+    size_t size;
+    bool mapped;
+    std::vector<char> buffer;
+    std::vector<std::string> names;
+    std::vector<Block> blocks;
+    size_t rows;
+    std::string error;
+};
+
+#endif //_TELEMETRY_H_
@@ -0,0 +1,64 @@
+/*
+ * iCub Robot Unit Tests (Robot Testing Framework)
+ *
+ * Copyright (C) 2015-2019 Istituto Italiano di Tecnologia (IIT)
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include "Telemetry.h"
+
+/**
+ * Converts a telemetry file recorded by the tests to text:
+ *
+ *   telemetryToText <file> [<output>] [--octave]
+ *
+ * The output is CSV with the channel names in the first line or, with
+ * --octave, space separated values without header as read by load().
+ */
+int main(int argc, char* argv[]) {
+    std::string input, output;
+    bool octave = false;
+    for(int i=1; i<argc; i++) {
+        if(strcmp(argv[i], "--octave") == 0)
+            octave = true;
+        else if(input.empty())
+            input = argv[i];
+        else
+            output = argv[i];
+    }
+    if(input.empty()) {
+        fprintf(stderr, "Usage: %s <file> [<output>] [--octave]\n", argv[0]);
+        return 1;
+    }
+    if(output.empty())
+        output = input.substr(0, input.rfind('.')) + (octave ? ".txt" : ".csv");
+
+    TelemetryReader reader;
+    if(!reader.open(input)) {
+        fprintf(stderr, "%s\n", reader.getError().c_str());
+        return 1;
+    }
+    if(!reader.exportText(output, octave ? ' ' : ',', !octave)) {
+        fprintf(stderr, "Unable to write %s\n", output.c_str());
+        return 1;
+    }
+    printf("%s: %zu rows of %zu channels written to %s\n", input.c_str(),
+           reader.getRows(), reader.getChannels(), output.c_str());
+    return 0;
+}
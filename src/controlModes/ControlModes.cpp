@@ -126,6 +126,9 @@ bool ControlModes::setup(yarp::os::Property& property) {
     Bottle* homePosBottle = property.find("home").asList();
     for (int i=0; i <n_cmd_joints; i++) home_pos[i]=homePosBottle->get(i).asFloat64();
 
+    std::vector<int> joints(jointsList, jointsList+n_cmd_joints);
+    ROBOTTESTINGFRAMEWORK_ASSERT_ERROR_IF_FALSE(controlBoard.configure(dd, joints), controlBoard.getError());
+
     checkJointWithTorqueMode();
     return true;
 }
@@ -190,10 +193,9 @@ void ControlModes::zeroCurrentLimits()
 
 void ControlModes::setMode(int desired_control_mode, yarp::dev::InteractionModeEnum desired_interaction_mode)
 {
-    for (int i=0; i<n_cmd_joints; i++)
-    {
-        setModeSingle(jointsList[i], desired_control_mode, desired_interaction_mode);
-    }
+    // the board may refuse the modes (e.g. in HW_FAULT): the caller verifies them
+    if (!controlBoard.setModes(desired_control_mode,desired_interaction_mode))
+        ROBOTTESTINGFRAMEWORK_TEST_REPORT("Unable to set control mode/interaction mode: "+controlBoard.getError());
 }
 
 void ControlModes::setModeSingle(int joint, int desired_control_mode, yarp::dev::InteractionModeEnum desired_interaction_mode)
@@ -205,28 +207,9 @@ void ControlModes::setModeSingle(int joint, int desired_control_mode, yarp::dev:
 
 void ControlModes::verifyMode(int desired_control_mode, yarp::dev::InteractionModeEnum desired_interaction_mode, std::string title)
 {
-    int cmode;
-    yarp::dev::InteractionModeEnum imode;
-    int timeout = 0;
-
-    while (1)
+    if (!controlBoard.verifyModes(desired_control_mode,desired_interaction_mode))
     {
-        int ok=0;
-        for (int i=0; i<n_cmd_joints; i++)
-        {
-            icmd->getControlMode (jointsList[i],&cmode);
-            iimd->getInteractionMode(jointsList[i],&imode);
-            if (cmode==desired_control_mode && imode==desired_interaction_mode) ok++;
-        }
-        if (ok==n_cmd_joints) break;
-        if (timeout>100)
-        {
-            char sbuf[500];
-            sprintf(sbuf,"Test (%s) failed: current mode is (%s,%s), it should be (%s,%s)",title.c_str(), Vocab32::decode((NetInt32)cmode).c_str(), Vocab32::decode((NetInt32)imode).c_str(), Vocab32::decode((NetInt32)desired_control_mode).c_str(),Vocab32::decode((NetInt32)desired_interaction_mode).c_str());
-            ROBOTTESTINGFRAMEWORK_ASSERT_ERROR(sbuf);
-        }
-        yarp::os::Time::delay(0.2);
-        timeout++;
+        ROBOTTESTINGFRAMEWORK_ASSERT_ERROR(Asserter::format("Test (%s) failed: %s",title.c_str(),controlBoard.getError().c_str()));
     }
     char sbuf[500];
     sprintf(sbuf,"Test (%s) passed: current mode is (%s,%s)",title.c_str(),Vocab32::decode((NetInt32)desired_control_mode).c_str(), Vocab32::decode((NetInt32)desired_interaction_mode).c_str());
@@ -344,29 +327,9 @@ void ControlModes::executeCmd()
 
 void ControlModes::goHome()
 {
-    for (int i=0; i<n_cmd_joints; i++)
-    {
-        ipos->setRefSpeed(jointsList[i],20.0);
-        ipos->positionMove(jointsList[i],home_pos[i]);
-    }
-
-    int timeout = 0;
-    while (1)
-    {
-        int in_position=0;
-        for (int i=0; i<n_cmd_joints; i++)
-        {
-            ienc->getEncoder(jointsList[i],&pos_tot[jointsList[i]]);
-            if (fabs(pos_tot[jointsList[i]]-home_pos[i])<tolerance) in_position++;
-        }
-        if (in_position==n_cmd_joints) break;
-        if (timeout>100)
-        {
-            ROBOTTESTINGFRAMEWORK_ASSERT_ERROR("Timeout while reaching zero position");
-        }
-        yarp::os::Time::delay(0.2);
-        timeout++;
-    }
+    std::vector<double> positions(home_pos, home_pos+n_cmd_joints);
+    ROBOTTESTINGFRAMEWORK_ASSERT_ERROR_IF_FALSE(controlBoard.goHome(positions, 20.0, tolerance, 20.0),
+                                                "Timeout while reaching zero position: "+controlBoard.getError());
 }
 
 
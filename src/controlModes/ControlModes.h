@@ -25,6 +25,7 @@
 #include <yarp/robottestingframework/TestCase.h>
 #include <yarp/dev/ControlBoardInterfaces.h>
 #include <yarp/dev/PolyDriver.h>
+#include "ControlBoardHelper.h"
 
 /**
 * \ingroup icub-tests
@@ -98,6 +99,7 @@ private:
     yarp::dev::IControlMode     *icmd;
     yarp::dev::IInteractionMode  *iimd;
     yarp::dev::IEncoders         *ienc;
+    ControlBoardHelper           controlBoard;
     yarp::dev::IPositionDirect   *idir;
     yarp::dev::IVelocityControl  *ivel;
     yarp::dev::ITorqueControl    *itrq;
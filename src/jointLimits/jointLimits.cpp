@@ -39,7 +39,7 @@ using namespace yarp::math;
 // prepare the plugin
 ROBOTTESTINGFRAMEWORK_PREPARE_PLUGIN(JointLimits)
 
-JointLimits::JointLimits() : yarp::robottestingframework::TestCase("JointLimits") {
+JointLimits::JointLimits() : MultiPartTestCase("JointLimits") {
     jointsList=0;
     dd=0;
     ipos=0;
@@ -54,7 +54,15 @@ JointLimits::JointLimits() : yarp::robottestingframework::TestCase("JointLimits"
 
 JointLimits::~JointLimits() { }
 
+MultiPartTestCase* JointLimits::createPartTest() {
+    return new JointLimits();
+}
+
 bool JointLimits::setup(yarp::os::Property& property) {
+    // several parts at once: an instance of this test for each of them
+    if(property.check("parts"))
+        return setupParts(property);
+
     if(property.check("name"))
         setName(property.find("name").asString());
 
@@ -166,6 +174,11 @@ bool JointLimits::setup(yarp::os::Property& property) {
         }
 
     }
+
+    std::vector<int> joints;
+    for (int i=0; i <n_cmd_joints; i++) joints.push_back((int)jointsList[i]);
+    ROBOTTESTINGFRAMEWORK_ASSERT_ERROR_IF_FALSE(controlBoard.configure(dd, joints), controlBoard.getError());
+
     return true;
 }
 
@@ -185,64 +198,25 @@ void JointLimits::tearDown()
     if (dd) {delete dd; dd =0;}
 }
 
-void JointLimits::setMode(int desired_mode)
+void JointLimits::interrupt()
 {
-    for (unsigned int i=0; i<jointsList.size(); i++)
-    {
-        icmd->setControlMode((int)jointsList[i],desired_mode);
-        iimd->setInteractionMode((int)jointsList[i],VOCAB_IM_STIFF);
-        yarp::os::Time::delay(0.010);
-    }
-
-    int cmode;
-    yarp::dev::InteractionModeEnum imode;
-    int timeout = 0;
+    MultiPartTestCase::interrupt();
+    controlBoard.interrupt();
+}
 
-    while (1)
-    {
-        int ok=0;
-        for (unsigned int i=0; i<jointsList.size(); i++)
-        {
-            icmd->getControlMode ((int)jointsList[i],&cmode);
-            iimd->getInteractionMode((int)jointsList[i],&imode);
-            if (cmode==desired_mode && imode==VOCAB_IM_STIFF) ok++;
-        }
-        if (ok==jointsList.size()) break;
-        if (timeout>100)
-        {
-            ROBOTTESTINGFRAMEWORK_ASSERT_ERROR("Unable to set control mode/interaction mode");
-        }
-        yarp::os::Time::delay(0.2);
-        timeout++;
-    }
+void JointLimits::setMode(int desired_mode)
+{
+    ROBOTTESTINGFRAMEWORK_ASSERT_ERROR_IF_FALSE(controlBoard.setAndVerifyModes(desired_mode,VOCAB_IM_STIFF),
+                                                "Unable to set control mode/interaction mode: "+controlBoard.getError());
 }
 
 void JointLimits::goTo(yarp::sig::Vector position)
 {
-    for (unsigned int i=0; i<jointsList.size(); i++)
-    {
-        ipos->setRefSpeed((int)jointsList[i],speed[i]);
-        ipos->positionMove((int)jointsList[i],position[i]);
-    }
-
-    int timeout = 0;
-    while (1)
-    {
-        int in_position=0;
-        for (unsigned int i=0; i<jointsList.size(); i++)
-        {
-            double tmp=0;
-            ienc->getEncoder((int)jointsList[i],&tmp);
-            if (fabs(tmp-position[i])<toleranceList[i]) in_position++;
-        }
-        if (in_position==jointsList.size()) break;
-        if (timeout>100)
-        {
-            ROBOTTESTINGFRAMEWORK_ASSERT_ERROR("Timeout while reaching desired position");
-        }
-        yarp::os::Time::delay(0.2);
-        timeout++;
-    }
+    std::vector<double> positions(position.data(), position.data()+position.size());
+    std::vector<double> speeds(speed.data(), speed.data()+speed.size());
+    std::vector<double> tolerances(toleranceList.data(), toleranceList.data()+toleranceList.size());
+    ROBOTTESTINGFRAMEWORK_ASSERT_ERROR_IF_FALSE(controlBoard.goHome(positions, speeds, tolerances, 20.0),
+                                                "Timeout while reaching desired position: "+controlBoard.getError());
 }
 
 bool JointLimits::goToSingle(int i, double pos, double *reached_pos)
@@ -254,6 +228,7 @@ bool JointLimits::goToSingle(int i, double pos, double *reached_pos)
     int timeout = 0;
     while (1)
     {
+        ROBOTTESTINGFRAMEWORK_ASSERT_ERROR_IF_FALSE(!controlBoard.stopIfInterrupted(), controlBoard.getError());
         ienc->getEncoder((int)jointsList[i],&tmp);
         if (fabs(tmp-pos)<toleranceList[i]) break;
 
@@ -295,6 +270,7 @@ bool JointLimits::goToSingleExceed(int i, double position_to_reach, double limit
     }
     while (1)
     {
+        ROBOTTESTINGFRAMEWORK_ASSERT_ERROR_IF_FALSE(!controlBoard.stopIfInterrupted(), controlBoard.getError());
         ienc->getEncoder((int)jointsList[i], &tmp);
         if(fabs(tmp - limitToCheck)>toleranceList[i])
         {
@@ -339,6 +315,12 @@ bool JointLimits::goToSingleExceed(int i, double position_to_reach, double limit
 
 void JointLimits::run()
 {
+    if(multiPart())
+    {
+        runParts();
+        return;
+    }
+
     char buff[500];
     setMode(VOCAB_CM_POSITION);
     ROBOTTESTINGFRAMEWORK_TEST_REPORT("all joints are going to home....");
@@ -25,6 +25,8 @@
 #include <yarp/robottestingframework/TestCase.h>
 #include <yarp/dev/ControlBoardInterfaces.h>
 #include <yarp/dev/PolyDriver.h>
+#include "ControlBoardHelper.h"
+#include "MultiPartTestCase.h"
 #include <yarp/sig/Vector.h>
 #include <yarp/os/Bottle.h>
 #include <yarp/sig/Matrix.h>
@@ -41,8 +43,11 @@
 * The test assumes the the position control is properly working and the position pid is properly tuned.
 * After testing the limits, this test also tries to move the joint out of the limits on puropose (adding to the joint limits the value of outOfBoundPosition).
 * The test is successfull if the position move command is correctly stopped at the limit.
+* With the parts parameter the test runs on several parts at the same time, one thread per part (see MultiPartTestCase):
+* the parameters of each part are given in the group named after it, and an error on any part stops all of them.
 *
 * Example: testRunner -v -t JointLimits.dll -p "--robot icub --part head --joints ""(0 1 2)"" --home ""(0 0 0)"" --speed ""(20 20 20)"" --outputLimitPercent ""(30 30 30)"" --outOfBoundPosition ""(2 2 2)"" --tolerance 0.2"
+* Example: testRunner -v -t JointLimits.dll -p "--robot icub --parts ""(left_arm right_arm)"" --tolerance 0.2 --left_arm::joints ""(0 1 2)"" --left_arm::home ""(0 0 0)"" ... --right_arm::joints ""(0 1 2)"" ..."
 *
 * Check the following functions:
 * \li IControlLimits::getLimits()
@@ -68,10 +73,11 @@
 * | tolerance          | vector of doubles of size joints | deg   | - | Yes | The position tolerance used to check if the limit has been properly reached. | Typical value = 0.2 deg. |
 * | outputLimitPercent | vector of doubles of size joints | %     | - | Yes | The maximum motor output (expressed as percentage). | Safe values can be, for example, 30%.|
 * | outOfBoundPosition | vector of doubles of size joints | %     | - | Yes | This value is added the joint limit to test that a position command is not able to move out of the joint limits | Typical value 2 deg.|
+* | parts              | vector of strings | -  | - | No  | The parts to be tested at the same time, instead of part | e.g. (left_arm right_arm) |
 *
 */
 
-class JointLimits : public yarp::robottestingframework::TestCase {
+class JointLimits : public MultiPartTestCase {
 public:
     JointLimits();
     virtual ~JointLimits();
@@ -82,6 +88,8 @@ public:
 
     virtual void run();
 
+    virtual void interrupt();
+
     void goTo(yarp::sig::Vector position);
     bool goToSingle(int i, double pos, double *reached_pos);
     bool goToSingleExceed(int i, double position_to_reach, double limit, double reachedLimit, double *reached_pos);
@@ -90,6 +98,8 @@ public:
     void saveToFile(std::string filename, yarp::os::Bottle &b);
 
 private:
+    virtual MultiPartTestCase* createPartTest();
+
     std::string robotName;
     std::string partName;
     yarp::sig::Vector jointsList;
@@ -103,6 +113,7 @@ private:
     yarp::dev::IControlMode     *icmd;
     yarp::dev::IInteractionMode  *iimd;
     yarp::dev::IEncoders         *ienc;
+    ControlBoardHelper           controlBoard;
     yarp::dev::IControlLimits    *ilim;
     yarp::dev::IPidControl       *ipid;
 
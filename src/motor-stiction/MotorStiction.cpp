@@ -125,6 +125,11 @@ bool MotorStiction::setup(yarp::os::Property& property) {
     min_lims.resize(n_cmd_joints);
     for (int i=0; i <n_cmd_joints; i++) ilim->getLimits((int)jointsList[i],&min_lims[i],&max_lims[i]);
 
+    std::vector<int> joints;
+    for (int i=0; i <n_cmd_joints; i++) joints.push_back((int)jointsList[i]);
+    ROBOTTESTINGFRAMEWORK_ASSERT_ERROR_IF_FALSE(controlBoard.configure(dd, joints), controlBoard.getError());
+    scheduler.setPeriod(0.010);
+
     return true;
 }
 
@@ -140,12 +145,8 @@ void MotorStiction::tearDown()
 
 void MotorStiction::setMode(int desired_control_mode, yarp::dev::InteractionModeEnum desired_interaction_mode)
 {
-    for (unsigned int i=0; i<jointsList.size(); i++)
-    {
-        icmd->setControlMode((int)jointsList[i],desired_control_mode);
-        iimd->setInteractionMode((int)jointsList[i],desired_interaction_mode);
-        yarp::os::Time::delay(0.010);
-    }
+    ROBOTTESTINGFRAMEWORK_ASSERT_ERROR_IF_FALSE(controlBoard.setModes(desired_control_mode,desired_interaction_mode),
+                                                "Unable to set control mode/interaction mode: "+controlBoard.getError());
 }
 
 void MotorStiction::setModeSingle(int i, int desired_control_mode, yarp::dev::InteractionModeEnum desired_interaction_mode)
@@ -157,28 +158,9 @@ void MotorStiction::setModeSingle(int i, int desired_control_mode, yarp::dev::In
 
 void MotorStiction::verifyMode(int desired_control_mode, yarp::dev::InteractionModeEnum desired_interaction_mode, std::string title)
 {
-    int cmode;
-    yarp::dev::InteractionModeEnum imode;
-    int timeout = 0;
-
-    while (1)
+    if (!controlBoard.verifyModes(desired_control_mode,desired_interaction_mode))
     {
-        int ok=0;
-        for (unsigned int i=0; i<jointsList.size(); i++)
-        {
-            icmd->getControlMode ((int)jointsList[i],&cmode);
-            iimd->getInteractionMode((int)jointsList[i],&imode);
-            if (cmode==desired_control_mode && imode==desired_interaction_mode) ok++;
-        }
-        if (ok==jointsList.size()) break;
-        if (timeout>100)
-        {
-            char sbuf[500];
-            sprintf(sbuf,"Test (%s) failed: current mode is (%d,%d), it should be (%d,%d)",title.c_str(), desired_control_mode,desired_interaction_mode,cmode,imode);
-            ROBOTTESTINGFRAMEWORK_ASSERT_ERROR(sbuf);
-        }
-        yarp::os::Time::delay(0.2);
-        timeout++;
+        ROBOTTESTINGFRAMEWORK_ASSERT_ERROR(Asserter::format("Test (%s) failed: %s",title.c_str(),controlBoard.getError().c_str()));
     }
     char sbuf[500];
     sprintf(sbuf,"Test (%s) passed: current mode is (%d,%d)",title.c_str(), desired_control_mode,desired_interaction_mode);
@@ -187,50 +169,20 @@ void MotorStiction::verifyMode(int desired_control_mode, yarp::dev::InteractionM
 
 void MotorStiction::goHome()
 {
-    for (unsigned int i=0; i<jointsList.size(); i++)
-    {
-        ipos->setRefSpeed((int)jointsList[i],20.0);
-        ipos->positionMove((int)jointsList[i],home[i]);
-        yarp::os::Time::delay(0.010);
-    }
-
     char buff [500];
     sprintf(buff,"Homing the whole part");ROBOTTESTINGFRAMEWORK_TEST_REPORT(buff);
 
-    int in_position=0;
-    for (unsigned int i=0; i<jointsList.size(); i++)
-    {
-        double time_started = yarp::os::Time::now();
-        while (1)
-        {
-            double pos;
-            ienc->getEncoder((int)jointsList[i],&pos);
-            if (fabs(pos-home[i])<1.0) break;
-            if (yarp::os::Time::now()-time_started>20)
-            {
-                sprintf(buff,"Timeout while reaching zero position, joint %d, curr_enc %f, home %f", (int)jointsList[i],pos,home[i]);
-                ROBOTTESTINGFRAMEWORK_ASSERT_ERROR(buff);
-            }
-        }
-    }
+    std::vector<double> positions(home.data(), home.data()+home.size());
+    double settlingTime = 0;
+    ROBOTTESTINGFRAMEWORK_ASSERT_ERROR_IF_FALSE(controlBoard.goHome(positions, 20.0, 1.0, 20.0, &settlingTime),
+                                                "Timeout while reaching zero position: "+controlBoard.getError());
 
-    sprintf(buff,"Homing succesfully completed");ROBOTTESTINGFRAMEWORK_TEST_REPORT(buff);
+    sprintf(buff,"Homing succesfully completed in %.3f s",settlingTime);ROBOTTESTINGFRAMEWORK_TEST_REPORT(buff);
 }
 
 void MotorStiction::saveToFile(std::string filename, yarp::os::Bottle &b)
 {
-    std::fstream fs;
-    fs.open (filename.c_str(), std::fstream::out);
-
-    for (int i=0; i<b.size(); i++)
-    {
-        std::string s = b.get(i).toString();
-        std::replace(s.begin(), s.end(), '(', ' ');
-        std::replace(s.begin(), s.end(), ')', ' ');
-        fs << s << std::endl;
-    }
-
-    fs.close();
+    ControlBoardHelper::saveToFile(filename, b);
 }
 
 void MotorStiction::OplExecute(int i, std::vector<yarp::os::Bottle>& dataToPlotList, stiction_data& current_test, bool positive_sign)
@@ -249,6 +201,7 @@ void MotorStiction::OplExecute(int i, std::vector<yarp::os::Bottle>& dataToPlotL
     double last_opl_cmd=yarp::os::Time::now();
     Bottle dataToPlot;
 
+    scheduler.start();
     while (not_moving)
     {
         Bottle& row = dataToPlot.addList();
@@ -302,7 +255,7 @@ void MotorStiction::OplExecute(int i, std::vector<yarp::os::Bottle>& dataToPlotL
         v1.addFloat64(time);
         v2.addFloat64(enc);
         v2.addFloat64(opl);
-        yarp::os::Time::delay(0.010);
+        scheduler.waitNext();
 
         if (time-time_old>5.0 && not_moving==true)
         {
@@ -310,6 +263,7 @@ void MotorStiction::OplExecute(int i, std::vector<yarp::os::Bottle>& dataToPlotL
             time_old=time;
         }
     }
+    ROBOTTESTINGFRAMEWORK_TEST_REPORT(scheduler.report());
 }
 
 void MotorStiction::OplExecute2(int i, std::vector<yarp::os::Bottle>& dataToPlotList, stiction_data& current_test, bool positive_sign)
@@ -328,6 +282,7 @@ void MotorStiction::OplExecute2(int i, std::vector<yarp::os::Bottle>& dataToPlot
     double last_opl_cmd=yarp::os::Time::now();
     Bottle dataToPlot;
 
+    scheduler.start();
     while (not_moving)
     {
         Bottle& row = dataToPlot.addList();
@@ -372,7 +327,7 @@ void MotorStiction::OplExecute2(int i, std::vector<yarp::os::Bottle>& dataToPlot
         v1.addFloat64(time);
         v2.addFloat64(enc);
         v2.addFloat64(opl);
-        yarp::os::Time::delay(0.010);
+        scheduler.waitNext();
 
         if (time-time_old>5.0 && not_moving==true)
         {
@@ -380,6 +335,7 @@ void MotorStiction::OplExecute2(int i, std::vector<yarp::os::Bottle>& dataToPlot
             time_old=time;
         }
     }
+    ROBOTTESTINGFRAMEWORK_TEST_REPORT(scheduler.report());
 }
 
 void MotorStiction::run()
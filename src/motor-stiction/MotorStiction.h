@@ -26,6 +26,8 @@
 #include <yarp/robottestingframework/TestCase.h>
 #include <yarp/dev/ControlBoardInterfaces.h>
 #include <yarp/dev/PolyDriver.h>
+#include "ControlBoardHelper.h"
+#include "FixedRateScheduler.h"
 #include <yarp/sig/Vector.h>
 #include <yarp/os/Bottle.h>
 #include <yarp/sig/Matrix.h>
@@ -90,6 +92,8 @@ private:
     yarp::dev::IControlMode     *icmd;
     yarp::dev::IInteractionMode  *iimd;
     yarp::dev::IEncoders         *ienc;
+    ControlBoardHelper           controlBoard;
+    FixedRateScheduler           scheduler;
     yarp::dev::IPWMControl       *ipwm;
     yarp::dev::IControlLimits    *ilim;
 };
@@ -46,13 +46,14 @@ using namespace yarp::math;
 // prepare the plugin
 ROBOTTESTINGFRAMEWORK_PREPARE_PLUGIN(OpticalEncodersConsistency)
 
-OpticalEncodersConsistency::OpticalEncodersConsistency() : yarp::robottestingframework::TestCase("OpticalEncodersConsistency") {
+OpticalEncodersConsistency::OpticalEncodersConsistency() : MultiPartTestCase("OpticalEncodersConsistency") {
     jointsList=0;
     dd=0;
     ipos=0;
     icmd=0;
     iimd=0;
     ienc=0;
+    ienct=0;
     imot=0;
     imotenc=0;
 
@@ -67,12 +68,22 @@ OpticalEncodersConsistency::OpticalEncodersConsistency() : yarp::robottestingfra
     acc_mot=0;
     cycles =10;
     tolerance = 1.0;
+    residual_tolerance = -1;
+    coupling_tolerance = 0.05;
+    sampleTime = 0.010;
     plot_enabled = false;
 }
 
 OpticalEncodersConsistency::~OpticalEncodersConsistency() { }
 
+MultiPartTestCase* OpticalEncodersConsistency::createPartTest() {
+    return new OpticalEncodersConsistency();
+}
+
 bool OpticalEncodersConsistency::setup(yarp::os::Property& property) {
+    // several parts at once: an instance of this test for each of them
+    if(property.check("parts"))
+        return setupParts(property);
 
     if(property.check("name"))
         setName(property.find("name").asString());
@@ -152,6 +163,18 @@ bool OpticalEncodersConsistency::setup(yarp::os::Property& property) {
     //optional parameters
     if (property.check("cycles"))
     {cycles = property.find("cycles").asInt32();}
+    if (property.check("sampleTime"))
+    {sampleTime = property.find("sampleTime").asFloat64();}
+    ROBOTTESTINGFRAMEWORK_ASSERT_ERROR_IF_FALSE(sampleTime>0,"invalid sampleTime");
+    int sg_window = property.check("sg_window") ? property.find("sg_window").asInt32() : 9;
+    int sg_degree = property.check("sg_degree") ? property.find("sg_degree").asInt32() : 2;
+    if (property.check("coupling_tolerance"))
+    {coupling_tolerance = property.find("coupling_tolerance").asFloat64();}
+    ROBOTTESTINGFRAMEWORK_ASSERT_ERROR_IF_FALSE(coupling_tolerance>0,"invalid coupling_tolerance");
+    residual_tolerance = tolerance;
+    if (property.check("residual_tolerance"))
+    {residual_tolerance = property.find("residual_tolerance").asFloat64();}
+    ROBOTTESTINGFRAMEWORK_ASSERT_ERROR_IF_FALSE(residual_tolerance>0,"invalid residual_tolerance");
 
     Property options;
     options.put("device", "remote_controlboard");
@@ -161,6 +184,7 @@ bool OpticalEncodersConsistency::setup(yarp::os::Property& property) {
     dd = new PolyDriver(options);
     ROBOTTESTINGFRAMEWORK_ASSERT_ERROR_IF_FALSE(dd->isValid(),"Unable to open device driver");
     ROBOTTESTINGFRAMEWORK_ASSERT_ERROR_IF_FALSE(dd->view(ienc),"Unable to open encoders interface");
+    ROBOTTESTINGFRAMEWORK_ASSERT_ERROR_IF_FALSE(dd->view(ienct),"Unable to open timed encoders interface");
     ROBOTTESTINGFRAMEWORK_ASSERT_ERROR_IF_FALSE(dd->view(ipos),"Unable to open position interface");
     ROBOTTESTINGFRAMEWORK_ASSERT_ERROR_IF_FALSE(dd->view(icmd),"Unable to open control mode interface");
     ROBOTTESTINGFRAMEWORK_ASSERT_ERROR_IF_FALSE(dd->view(iimd),"Unable to open interaction mode interface");
@@ -185,15 +209,8 @@ bool OpticalEncodersConsistency::setup(yarp::os::Property& property) {
     vel_mot.resize(n_cmd_joints); vel_mot.zero();
     acc_jnt.resize(n_cmd_joints); acc_jnt.zero();
     acc_mot.resize(n_cmd_joints); acc_mot.zero();
-    prev_enc_jnt.resize(n_cmd_joints); prev_enc_jnt.zero();
-    prev_enc_mot.resize(n_cmd_joints); prev_enc_mot.zero();
-    prev_enc_jnt2mot.resize(n_cmd_joints); prev_enc_jnt2mot.zero();
-    prev_vel_jnt.resize(n_cmd_joints); prev_vel_jnt.zero();
-    prev_vel_mot.resize(n_cmd_joints); prev_vel_mot.zero();
-    prev_vel_jnt2mot.resize(n_cmd_joints); prev_vel_jnt2mot.zero();
-    prev_acc_jnt.resize(n_cmd_joints); prev_acc_jnt.zero();
-    prev_acc_mot.resize(n_cmd_joints); prev_acc_mot.zero();
-    prev_acc_jnt2mot.resize(n_cmd_joints); prev_acc_jnt2mot.zero();
+    diff_enc_jnt.resize(n_cmd_joints); diff_enc_jnt.zero();
+    diff_enc_mot.resize(n_cmd_joints); diff_enc_mot.zero();
     zero_vector.resize(n_cmd_joints);
     zero_vector.zero();
 
@@ -209,109 +226,74 @@ bool OpticalEncodersConsistency::setup(yarp::os::Property& property) {
         gearbox[i]=t;
     }
 
+    std::vector<int> joints;
+    for (int i=0; i <n_cmd_joints; i++) joints.push_back((int)jointsList[i]);
+    ROBOTTESTINGFRAMEWORK_ASSERT_ERROR_IF_FALSE(controlBoard.configure(dd, joints), controlBoard.getError());
+
+    //the channels: joint and motor positions, then joint and motor velocities
+    ROBOTTESTINGFRAMEWORK_ASSERT_ERROR_IF_FALSE(sg_window>0 && sg_degree>0 && differentiator.configure(sg_window, sg_degree, 4*n_cmd_joints),
+                                                "invalid sg_window/sg_degree: the window must be odd and larger than the degree");
+    scheduler.setPeriod(sampleTime);
 
     return true;
 }
 
 void OpticalEncodersConsistency::tearDown()
 {
+    if (multiPart()) return;
+
     char buff[500];
     sprintf(buff,"Closing test module");ROBOTTESTINGFRAMEWORK_TEST_REPORT(buff);
-    setMode(VOCAB_CM_POSITION);
-    goHome();
+    //after a safety stop the joints are left where they have been stopped
+    if (!controlBoard.isInterrupted())
+    {
+        setMode(VOCAB_CM_POSITION);
+        goHome();
+    }
     if (dd) {delete dd; dd =0;}
 }
 
-void OpticalEncodersConsistency::setMode(int desired_mode)
+void OpticalEncodersConsistency::interrupt()
 {
-    if (icmd == 0) ROBOTTESTINGFRAMEWORK_ASSERT_ERROR("Invalid control mode interface");
-    if (iimd == 0) ROBOTTESTINGFRAMEWORK_ASSERT_ERROR("Invalid interaction mode interface");
-
-    for (unsigned int i=0; i<jointsList.size(); i++)
-    {
-        icmd->setControlMode((int)jointsList[i],desired_mode);
-        iimd->setInteractionMode((int)jointsList[i],VOCAB_IM_STIFF);
-        yarp::os::Time::delay(0.010);
-    }
-
-    int cmode;
-    yarp::dev::InteractionModeEnum imode;
-    int timeout = 0;
+    MultiPartTestCase::interrupt();
+    controlBoard.interrupt();
+}
 
-    while (1)
-    {
-        int ok=0;
-        for (unsigned int i=0; i<jointsList.size(); i++)
-        {
-            icmd->getControlMode ((int)jointsList[i],&cmode);
-            iimd->getInteractionMode((int)jointsList[i],&imode);
-            if (cmode==desired_mode && imode==VOCAB_IM_STIFF) ok++;
-        }
-        if (ok==jointsList.size()) break;
-        if (timeout>100)
-        {
-            ROBOTTESTINGFRAMEWORK_ASSERT_ERROR("Unable to set control mode/interaction mode");
-        }
-        yarp::os::Time::delay(0.2);
-        timeout++;
-    }
+void OpticalEncodersConsistency::setMode(int desired_mode)
+{
+    ROBOTTESTINGFRAMEWORK_ASSERT_ERROR_IF_FALSE(controlBoard.setAndVerifyModes(desired_mode,VOCAB_IM_STIFF),
+                                                "Unable to set control mode/interaction mode: "+controlBoard.getError());
 }
 
 void OpticalEncodersConsistency::goHome()
 {
-    if (ipos == 0) ROBOTTESTINGFRAMEWORK_ASSERT_ERROR("Invalid position control interface");
-    if (ienc == 0) ROBOTTESTINGFRAMEWORK_ASSERT_ERROR("Invalid encoders interface");
-
-    bool ret = true;
     char buff [500];
     sprintf(buff,"Homing the whole part");ROBOTTESTINGFRAMEWORK_TEST_REPORT(buff);
 
-    for (unsigned int i=0; i<jointsList.size(); i++)
-    {
-        ret = ipos->setRefSpeed((int)jointsList[i],speed[i]);
-        ROBOTTESTINGFRAMEWORK_ASSERT_ERROR_IF_FALSE(ret, "ipos->setRefSpeed returned false");
-        ret = ipos->positionMove((int)jointsList[i],home[i]);
-        ROBOTTESTINGFRAMEWORK_ASSERT_ERROR_IF_FALSE(ret, "ipos->positionMove returned false");
-    }
-
-    int timeout = 0;
-    while (1)
-    {
-        int in_position=0;
-        for (unsigned int i=0; i<jointsList.size(); i++)
-        {
-            double tmp=0;
-            ienc->getEncoder((int)jointsList[i],&tmp);
-            if (fabs(tmp-home[i])<tolerance) in_position++;
-        }
-        if (in_position==jointsList.size()) break;
-        if (timeout>100)
-        {
-            ROBOTTESTINGFRAMEWORK_ASSERT_ERROR("Timeout while reaching home position");
-        }
-        yarp::os::Time::delay(0.2);
-        timeout++;
-    }
+    std::vector<double> positions(home.data(), home.data()+home.size());
+    std::vector<double> speeds(speed.data(), speed.data()+speed.size());
+    double settlingTime = 0;
+    ROBOTTESTINGFRAMEWORK_ASSERT_ERROR_IF_FALSE(controlBoard.goHome(positions, speeds, tolerance, 20.0, &settlingTime),
+                                                "Timeout while reaching home position: "+controlBoard.getError());
+    sprintf(buff,"Homing completed in %.3f s",settlingTime);ROBOTTESTINGFRAMEWORK_TEST_REPORT(buff);
 }
 
-void OpticalEncodersConsistency::saveToFile(std::string filename, yarp::os::Bottle &b)
+void OpticalEncodersConsistency::openTelemetry(TelemetryRecorder& recorder, std::string filename, std::string name1, std::string name2)
 {
-    std::fstream fs;
-    fs.open (filename.c_str(), std::fstream::out);
-
-    for (int i=0; i<b.size(); i++)
-    {
-        std::string s = b.get(i).toString();
-        std::replace(s.begin(), s.end(), '(', ' ');
-        std::replace(s.begin(), s.end(), ')', ' ');
-        fs << s << endl;
-    }
-
-    fs.close();
+    std::vector<std::string> channels = TelemetryRecorder::channelNames(name1+"_", jointsList.size());
+    std::vector<std::string> channels2 = TelemetryRecorder::channelNames(name2+"_", jointsList.size());
+    channels.insert(channels.end(), channels2.begin(), channels2.end());
+    ROBOTTESTINGFRAMEWORK_ASSERT_ERROR_IF_FALSE(recorder.open(filename, channels), recorder.getError());
 }
 
 void OpticalEncodersConsistency::run()
 {
+    if (multiPart())
+    {
+        runParts();
+        return;
+    }
+
     char buff [500];
     setMode(VOCAB_CM_POSITION);
     goHome();
@@ -385,11 +367,20 @@ void OpticalEncodersConsistency::run()
     sprintf(buff,"Inv matrix:\n %s \n", inv_matrix.toString().c_str());
     ROBOTTESTINGFRAMEWORK_TEST_REPORT(buff);
 
-    Bottle dataToPlot_test1;
-    Bottle dataToPlot_test2;
-    Bottle dataToPlot_test3;
-    Bottle dataToPlot_test4;
-    Bottle dataToPlot_test1rev;
+    //the data to plot are streamed to file, so the memory does not grow with the number of cycles
+    string partfilename = partName+".tlm";
+    string testfilename = "encConsis_";
+    size_t n_cmd_joints = jointsList.size();
+    TelemetryRecorder dataToPlot_test1;
+    TelemetryRecorder dataToPlot_test2;
+    TelemetryRecorder dataToPlot_test3;
+    TelemetryRecorder dataToPlot_test4;
+    TelemetryRecorder dataToPlot_test1rev;
+    openTelemetry(dataToPlot_test1, testfilename + "jointPos_MotorPos_" + partfilename, "mot_pos", "jnt2mot_pos");
+    openTelemetry(dataToPlot_test2, testfilename + "jointVel_motorVel_" + partfilename, "mot_vel", "jnt2mot_vel");
+    openTelemetry(dataToPlot_test3, testfilename + "joint_derivedVel_vel_" + partfilename, "jnt_vel", "jnt_diff_pos");
+    openTelemetry(dataToPlot_test4, testfilename + "motor_derivedVel_vel_" + partfilename, "mot_vel", "mot_diff_pos");
+    openTelemetry(dataToPlot_test1rev, testfilename + "jointPos_MotorPos_reversed_" + partfilename, "jnt_pos", "mot2jnt_pos");
 
     bool test_data_is_valid = false;
     bool first_time = true;
@@ -399,23 +390,51 @@ void OpticalEncodersConsistency::run()
     yarp::sig::Vector off_enc_mot2jnt; off_enc_mot2jnt.resize(jointsList.size());
     yarp::sig::Vector tmp_vector;
     tmp_vector.resize(n_part_joints);
+    std::vector<double> stamps(n_part_joints);
+    std::vector<double> sample(4*n_cmd_joints);
+    std::vector<double> center_sample(4*n_cmd_joints);
+    std::vector<double> derivatives(2*n_cmd_joints);
+    double prev_stamp = -1.0;
+    differentiator.clear();
+
+    //the configured joint to motor map, mot = gearbox * kinematic_mj * jnt.
+    //Each motor is fitted on the joints it is coupled with; the residuals of the
+    //configured map also reveal the couplings which are missing from it
+    yarp::sig::Matrix expected_map = matrix;
+    for (int r = 0; r < expected_map.rows(); r++)
+        for (int c = 0; c < expected_map.cols(); c++)
+            expected_map(r, c) = gearbox[r] * matrix(r, c);
+    std::vector<LeastSquares> fits(n_cmd_joints);
+    std::vector<std::vector<size_t> > fit_joints(n_cmd_joints);
+    for (unsigned int i = 0; i < n_cmd_joints; i++)
+    {
+        for (unsigned int j = 0; j < n_cmd_joints; j++)
+            if (expected_map(i, j) != 0) fit_joints[i].push_back(j);
+        fits[i].configure(fit_joints[i].size(), 1);
+    }
+    LeastSquares configured_fit(0, n_cmd_joints);
+    std::vector<double> fit_x(n_cmd_joints);
+    std::vector<double> configured_error(n_cmd_joints);
 
 
 
+    scheduler.start();
     while (1)
     {
+        ROBOTTESTINGFRAMEWORK_ASSERT_ERROR_IF_FALSE(!controlBoard.stopIfInterrupted(), controlBoard.getError());
         double curr_time = yarp::os::Time::now();
         double elapsed = curr_time - start_time;
 
         bool ret = true;
-        ret = ienc->getEncoders(tmp_vector.data());
+        ret = ienct->getEncodersTimed(tmp_vector.data(), stamps.data());
         for (unsigned int i = 0; i < jointsList.size(); i++)
             enc_jnt[i] = tmp_vector[jointsList[i]];
+        double stamp = stamps[jointsList[0]];
 
 
-        ROBOTTESTINGFRAMEWORK_ASSERT_ERROR_IF_FALSE(ret, "ienc->getEncoders returned false");
-        ret = imotenc->getMotorEncoders(tmp_vector.data());             for (unsigned int i = 0; i < jointsList.size(); i++) enc_mot[i] = tmp_vector[jointsList(i)];
-        ROBOTTESTINGFRAMEWORK_ASSERT_ERROR_IF_FALSE(ret, "imotenc->getMotorEncoder returned false");
+        ROBOTTESTINGFRAMEWORK_ASSERT_ERROR_IF_FALSE(ret, "ienct->getEncodersTimed returned false");
+        ret = imotenc->getMotorEncodersTimed(tmp_vector.data(), stamps.data());             for (unsigned int i = 0; i < jointsList.size(); i++) enc_mot[i] = tmp_vector[jointsList(i)];
+        ROBOTTESTINGFRAMEWORK_ASSERT_ERROR_IF_FALSE(ret, "imotenc->getMotorEncodersTimed returned false");
         ret = ienc->getEncoderSpeeds(tmp_vector.data());             for (unsigned int i = 0; i < jointsList.size(); i++) vel_jnt[i] = tmp_vector[jointsList(i)];
         ROBOTTESTINGFRAMEWORK_ASSERT_ERROR_IF_FALSE(ret, "ienc->getEncoderSpeeds returned false");
         ret = imotenc->getMotorEncoderSpeeds(tmp_vector.data());        for (unsigned int i = 0; i < jointsList.size(); i++) vel_mot[i] = tmp_vector[jointsList(i)];
@@ -487,25 +506,43 @@ void OpticalEncodersConsistency::run()
             }
         }
 
-        //update previous and computes diff
-        diff_enc_jnt = (enc_jnt - prev_enc_jnt) / 0.010;
-        diff_enc_mot = (enc_mot - prev_enc_mot) / 0.010;
-        diff_enc_jnt2mot = (enc_jnt2mot - prev_enc_jnt2mot) / 0.010;
-        diff_vel_jnt = (vel_jnt - prev_vel_jnt) / 0.010;
-        diff_vel_mot = (vel_mot - prev_vel_mot) / 0.010;
-        diff_vel_jnt2mot = (vel_jnt2mot - prev_vel_jnt2mot) / 0.010;
-        diff_acc_jnt = (acc_jnt - prev_acc_jnt) / 0.010;
-        diff_acc_mot = (acc_mot - prev_acc_mot) / 0.010;
-        //diff_acc_jnt2mot = (acc_jnt2mot - prev_acc_jnt2mot) / 0.010;
-        prev_enc_jnt = enc_jnt;
-        prev_enc_mot = enc_mot;
-        prev_enc_jnt2mot = enc_jnt2mot;
-        prev_vel_jnt = vel_jnt;
-        prev_vel_mot = vel_mot;
-        prev_vel_jnt2mot = vel_jnt2mot;
-       // prev_acc_jnt = acc_jnt;
-        //prev_acc_mot = acc_mot;
-       // prev_acc_jnt2mot = acc_jnt2mot;
+        //numerical derivatives of the positions, on the timestamps of the samples.
+        //Each sample of the state stream is used once, however fast the loop runs.
+        //The derivatives refer to the center of the window, so they are compared
+        //with the measured velocities of that sample
+        bool derived = false;
+        if (stamp != prev_stamp)
+        {
+            prev_stamp = stamp;
+            for (unsigned int i = 0; i < n_cmd_joints; i++)
+            {
+                sample[i] = enc_jnt[i];
+                sample[n_cmd_joints + i] = enc_mot[i];
+                sample[2*n_cmd_joints + i] = vel_jnt[i];
+                sample[3*n_cmd_joints + i] = vel_mot[i];
+            }
+            differentiator.push(stamp, sample.data());
+
+            for (unsigned int i = 0; i < n_cmd_joints; i++)
+            {
+                for (size_t k = 0; k < fit_joints[i].size(); k++) fit_x[k] = enc_jnt[fit_joints[i][k]];
+                fits[i].add(fit_x.data(), &enc_mot[i]);
+                configured_error[i] = enc_mot[i];
+                for (unsigned int j = 0; j < n_cmd_joints; j++) configured_error[i] -= expected_map(i, j) * enc_jnt[j];
+            }
+            configured_fit.add(0, configured_error.data());
+
+            derived = differentiator.derivative(derivatives.data(), 2*n_cmd_joints);
+            if (derived)
+            {
+                differentiator.center(center_sample.data());
+                for (unsigned int i = 0; i < n_cmd_joints; i++)
+                {
+                    diff_enc_jnt[i] = derivatives[i];
+                    diff_enc_mot[i] = derivatives[n_cmd_joints + i];
+                }
+            }
+        }
 
         if (first_time)
         {
@@ -516,57 +553,46 @@ void OpticalEncodersConsistency::run()
         {
             //prepare data to plot
             //JOINT POSITIONS vs MOTOR POSITIONS
-            Bottle& row_test1 = dataToPlot_test1.addList();
-            Bottle& v1_test1 = row_test1.addList();
-            Bottle& v2_test1 = row_test1.addList();
             yarp::sig::Vector v1 = enc_mot - off_enc_mot;
             yarp::sig::Vector v2 = enc_jnt2mot - off_enc_jnt2mot;
-            v1_test1.read(v1);
-            v2_test1.read(v2);
+            dataToPlot_test1.set(0, v1.data(), n_cmd_joints);
+            dataToPlot_test1.set(n_cmd_joints, v2.data(), n_cmd_joints);
+            dataToPlot_test1.commit();
         }
 
         {
             //JOINT VELOCITES vs MOTOR VELOCITIES
-            Bottle& row_test2 = dataToPlot_test2.addList();
-            Bottle& v1_test2 = row_test2.addList();
-            Bottle& v2_test2 = row_test2.addList();
-            v1_test2.read(vel_mot);
-            v2_test2.read(vel_jnt2mot);
+            dataToPlot_test2.set(0, vel_mot.data(), n_cmd_joints);
+            dataToPlot_test2.set(n_cmd_joints, vel_jnt2mot.data(), n_cmd_joints);
+            dataToPlot_test2.commit();
         }
 
         {
             //JOINT POSITIONS(DERIVED) vs JOINT SPEED
-            if (first_time == false)
+            if (derived)
             {
-                Bottle& row_test3 = dataToPlot_test3.addList();
-                Bottle& v1_test3 = row_test3.addList();
-                Bottle& v2_test3 = row_test3.addList();
-                v1_test3.read(vel_jnt);
-                v2_test3.read(diff_enc_jnt);
+                dataToPlot_test3.set(0, &center_sample[2*n_cmd_joints], n_cmd_joints);
+                dataToPlot_test3.set(n_cmd_joints, diff_enc_jnt.data(), n_cmd_joints);
+                dataToPlot_test3.commit();
             }
         }
 
         {
             //MOTOR POSITIONS(DERIVED) vs MOTOR SPEED
-            if (first_time == false)
+            if (derived)
             {
-                Bottle& row_test4 = dataToPlot_test4.addList();
-                Bottle& v1_test4 = row_test4.addList();
-                Bottle& v2_test4 = row_test4.addList();
-                v1_test4.read(vel_mot);
-                v2_test4.read(diff_enc_mot);
+                dataToPlot_test4.set(0, &center_sample[3*n_cmd_joints], n_cmd_joints);
+                dataToPlot_test4.set(n_cmd_joints, diff_enc_mot.data(), n_cmd_joints);
+                dataToPlot_test4.commit();
             }
         }
 
         {
             //JOINT POSITIONS vs MOTOR POSITIONS REVERSED
-            Bottle& row_test1 = dataToPlot_test1rev.addList();
-            Bottle& v1_test1 = row_test1.addList();
-            Bottle& v2_test1 = row_test1.addList();
-            yarp::sig::Vector v1 = enc_jnt;
             yarp::sig::Vector v2 = enc_mot2jnt + off_enc_jnt;
-            v1_test1.read(v1);
-            v2_test1.read(v2);
+            dataToPlot_test1rev.set(0, enc_jnt.data(), n_cmd_joints);
+            dataToPlot_test1rev.set(n_cmd_joints, v2.data(), n_cmd_joints);
+            dataToPlot_test1rev.commit();
         }
 
         //flag set
@@ -574,26 +600,54 @@ void OpticalEncodersConsistency::run()
 
         //exit condition
         if (cycle>=cycles) break;
+
+        scheduler.waitNext();
     }
+    ROBOTTESTINGFRAMEWORK_TEST_REPORT(scheduler.report());
 
     goHome();
 
     yarp::os::ResourceFinder rf;
     rf.setDefaultContext("scripts");
 
-    string partfilename = partName+".txt";
-    string testfilename = "encConsis_";
-    string filename1 = testfilename + "jointPos_MotorPos_" + partfilename;
-    saveToFile(filename1,dataToPlot_test1);
-    string filename2 = testfilename + "jointVel_motorVel_" + partfilename;
-    saveToFile(filename2,dataToPlot_test2);
-    string filename3 = testfilename + "joint_derivedVel_vel_" + partfilename;
-    saveToFile(filename3,dataToPlot_test3);
-    string filename4 = testfilename + "motor_derivedVel_vel_" + partfilename;
-    saveToFile(filename4,dataToPlot_test4);
-
-    string filename1rev = testfilename + "jointPos_MotorPos_reversed_" + partfilename;
-    saveToFile(filename1rev,dataToPlot_test1rev);
+    ROBOTTESTINGFRAMEWORK_TEST_CHECK(dataToPlot_test1.close() && dataToPlot_test2.close() &&
+                                     dataToPlot_test3.close() && dataToPlot_test4.close() &&
+                                     dataToPlot_test1rev.close(), "Saving the data to plot");
+
+    //****************************************************************************************
+    //Identification of the joint to motor map
+    //****************************************************************************************
+
+    ROBOTTESTINGFRAMEWORK_TEST_REPORT("Identifying the joint to motor map (gearbox * kinematic_mj) from the collected samples");
+    ROBOTTESTINGFRAMEWORK_ASSERT_ERROR_IF_FALSE(configured_fit.solve(), "Unable to check the joint to motor map: "+configured_fit.getError());
+    for (unsigned int i = 0; i < n_cmd_joints; i++)
+    {
+        //residuals and errors are given on the joint side, relative to the gearbox
+        double scale = fabs(gearbox[i]) > 0 ? fabs(gearbox[i]) : 1.0;
+        double residual = configured_fit.residual(i) / scale;
+        sprintf(buff, "Motor %d: rms residual of the configured map %.4f deg (tolerance %.4f)", (int)jointsList[i], residual, residual_tolerance);
+        ROBOTTESTINGFRAMEWORK_TEST_CHECK(residual <= residual_tolerance, buff);
+
+        if (!fits[i].solve())
+        {
+            sprintf(buff, "Motor %d: the coefficients cannot be identified (%s): move the coupled joints with different speeds or ranges",
+                    (int)jointsList[i], fits[i].getError().c_str());
+            ROBOTTESTINGFRAMEWORK_TEST_REPORT(buff);
+            continue;
+        }
+        for (size_t k = 0; k < fit_joints[i].size(); k++)
+        {
+            size_t j = fit_joints[i][k];
+            double identified = fits[i].coefficient(0, k);
+            double configured = expected_map(i, j);
+            double error = fabs(identified - configured) / scale;
+            sprintf(buff, "Motor %d, joint %d: identified %.4f, configured %.4f, error %.2f%% (tolerance %.2f%%)",
+                    (int)jointsList[i], (int)jointsList[j], identified, configured, error*100, coupling_tolerance*100);
+            ROBOTTESTINGFRAMEWORK_TEST_CHECK(error <= coupling_tolerance, buff);
+        }
+        sprintf(buff, "Motor %d: rms residual of the identified map %.4f deg", (int)jointsList[i], fits[i].residual(0) / scale);
+        ROBOTTESTINGFRAMEWORK_TEST_REPORT(buff);
+    }
 
     //find octave scripts
     std::string octaveFile = rf.findFile("encoderConsistencyPlotAll.m");
@@ -616,8 +670,7 @@ void OpticalEncodersConsistency::run()
     }
     else
     {
-         yInfo() << "Test has collected all data. You need to plot data to check is test is passed";
-         yInfo() << "Please run following command to plot data.";
+         yInfo() << "The plots of the collected data can be generated with the following command.";
          yInfo() << octaveCommand;
          yInfo() << "To exit from Octave application please type 'exit' command.";
     }
@@ -25,6 +25,12 @@
 #include <yarp/robottestingframework/TestCase.h>
 #include <yarp/dev/ControlBoardInterfaces.h>
 #include <yarp/dev/PolyDriver.h>
+#include "ControlBoardHelper.h"
+#include "MultiPartTestCase.h"
+#include "Telemetry.h"
+#include "FixedRateScheduler.h"
+#include "SavitzkyGolay.h"
+#include "LeastSquares.h"
 #include <yarp/sig/Vector.h>
 #include <yarp/sig/Matrix.h>
 
@@ -39,12 +45,18 @@
 * \li joint velocities vs motor velocities
 * \li joint positions (numerically derived by the test) vs joint velocities (measured by the control board)
 * \li motor positions (numerically derived by the test) vs motor velocities (measured by the control board)
+* The positions are derived with a Savitzky-Golay differentiator on the timestamps of the encoder readings.
 * The conversion formula from motor measurments (M) to joint encoder measurements (J) is the following:
 * J = kinematic_mj * gearbox * M
 * with kinematic_mj the joints coupling matrix and gearbox the gearbox reduction factor (e.g. 1:100)
+* The test identifies the map from the collected samples, fitting (least squares) each motor position on the positions of the joints it is coupled with,
+* and fails if the identified coefficients differ from the configured ones more than coupling_tolerance, or if the rms residual of the configured map
+* exceeds residual_tolerance. The plots are not needed to judge the result.
 
 * Example: testRunner v -t motorEncodersConsistency.dll -p "--robot icub --part left_arm --joints ""(0 1 2)"" --home ""(-30 30 10)"" --speed ""(20 20 20)"" --max ""(-20 40 20)"" --min ""(-40 20 0)"" --cycles 10 --tolerance 1.0 "
 * Example: testRunner v -s "..\icub-tests\suites\encoders-icubSim.xml"
+* With the parts parameter the test runs on several parts at the same time, one thread per part (see MultiPartTestCase):
+* the parameters of each part are given in the group named after it (e.g. --left_arm::joints "(0 1 2)"), and an error on any part stops all of them.
 
 * Check the following functions:
 * \li IEncoders::getEncoders()
@@ -67,9 +79,15 @@
 * | max                | vector of doubles of size joints  | deg   | - | Yes | The max position using during the joint movement | |
 * | min                | vector of doubles of size joints  | deg   | - | Yes | The min position using during the joint movement | |
 * | tolerance          | vector of doubles of size joints  | deg   | - | Yes | The tolerance used when moving from min to max reference position and viceversa | |
+* | sampleTime         | double | s     | 0.010         | No       | The period of the acquisition loop | |
+* | sg_window          | int    | -     | 9             | No       | The number of samples of the Savitzky-Golay differentiator | must be odd |
+* | sg_degree          | int    | -     | 2             | No       | The degree of the polynomial of the Savitzky-Golay differentiator | must be < sg_window |
+* | coupling_tolerance | double | -     | 0.05          | No       | The maximum error of the identified coefficients, relative to the gearbox | |
+* | residual_tolerance | double | deg   | tolerance     | No       | The maximum rms residual of the configured map, on the joint side | |
 * | speed              | vector of doubles of size joints  | deg/s | - | Yes | The reference speed used during the movement  | |
 * | matrix_size | int                                   | -     | - | Yes | The number of rows of the coupling matrix | Typical value = 4. |
 * | matrix      | vector of doubles of size matrix_size | -     | - | Yes | The kinematic_mj coupling matrix | matrix is identity if joints are not coupled |
+* | parts       | vector of strings | -                     | - | No  | The parts to be tested at the same time, instead of part | e.g. (left_arm right_arm) |
 * | plotstring1 | string |      | - | Yes | The string which generates plot 1 | |
 * | plotstring2 | string |      | - | Yes | The string which generates plot 2 | |
 * | plotstring3 | string |      | - | Yes | The string which generates plot 3 | |
@@ -77,7 +95,7 @@
 
 *
 */
-class OpticalEncodersConsistency : public yarp::robottestingframework::TestCase {
+class OpticalEncodersConsistency : public MultiPartTestCase {
 public:
     OpticalEncodersConsistency();
     virtual ~OpticalEncodersConsistency();
@@ -88,11 +106,15 @@ public:
 
     virtual void run();
 
+    virtual void interrupt();
+
     void goHome();
     void setMode(int desired_mode);
-    void saveToFile(std::string filename, yarp::os::Bottle &b);
+    void openTelemetry(TelemetryRecorder& recorder, std::string filename, std::string name1, std::string name2);
 
 private:
+    virtual MultiPartTestCase* createPartTest();
+
     std::string getPath(const std::string& str);
     std::string robotName;
     std::string partName;
@@ -104,6 +126,9 @@ private:
     yarp::sig::Vector jointsList;
 
     double tolerance;
+    double residual_tolerance;
+    double coupling_tolerance;
+    double sampleTime;
     bool plot_enabled;
 
     int    n_part_joints;
@@ -114,6 +139,10 @@ private:
     yarp::dev::IControlMode      *icmd;
     yarp::dev::IInteractionMode  *iimd;
     yarp::dev::IEncoders         *ienc;
+    yarp::dev::IEncodersTimed    *ienct;
+    ControlBoardHelper           controlBoard;
+    FixedRateScheduler           scheduler;
+    SavitzkyGolay                differentiator;
     yarp::dev::IMotorEncoders    *imotenc;
     yarp::dev::IMotor            *imot;
     yarp::dev::IRemoteVariables  *ivar;
@@ -132,31 +161,8 @@ private:
     yarp::sig::Vector acc_mot;
     yarp::sig::Vector acc_mot2jnt;
 
-    yarp::sig::Vector prev_enc_jnt;
-    yarp::sig::Vector prev_enc_jnt2mot;
-    yarp::sig::Vector prev_enc_mot;
-    yarp::sig::Vector prev_enc_mot2jnt;
-    yarp::sig::Vector prev_vel_jnt;
-    yarp::sig::Vector prev_vel_jnt2mot;
-    yarp::sig::Vector prev_vel_mot;
-    yarp::sig::Vector prev_vel_mot2jnt;
-    yarp::sig::Vector prev_acc_jnt;
-    yarp::sig::Vector prev_acc_jnt2mot;
-    yarp::sig::Vector prev_acc_mot;
-    yarp::sig::Vector prev_acc_mot2jnt;
-
     yarp::sig::Vector diff_enc_jnt;
-    yarp::sig::Vector diff_enc_jnt2mot;
     yarp::sig::Vector diff_enc_mot;
-    yarp::sig::Vector diff_enc_mot2jnt;
-    yarp::sig::Vector diff_vel_jnt;
-    yarp::sig::Vector diff_vel_jnt2mot;
-    yarp::sig::Vector diff_vel_mot;
-    yarp::sig::Vector diff_vel_mot2jnt;
-    yarp::sig::Vector diff_acc_jnt;
-    yarp::sig::Vector diff_acc_jnt2mot;
-    yarp::sig::Vector diff_acc_mot;
-    yarp::sig::Vector diff_acc_mot2jnt;
 
     yarp::sig::Vector max;
     yarp::sig::Vector min;
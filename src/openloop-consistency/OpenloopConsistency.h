@@ -25,6 +25,7 @@
 #include <yarp/robottestingframework/TestCase.h>
 #include <yarp/dev/ControlBoardInterfaces.h>
 #include <yarp/dev/PolyDriver.h>
+#include "ControlBoardHelper.h"
 
 class OpenLoopConsistency : public yarp::robottestingframework::TestCase {
 public:
@@ -69,6 +70,7 @@ private:
     yarp::dev::IInteractionMode  *iimd;
     yarp::dev::IEncoders         *ienc;
     yarp::dev::IPWMControl       *ipwm;
+    ControlBoardHelper           controlBoard;
 
     double  cmd_single;
     double* cmd_tot;
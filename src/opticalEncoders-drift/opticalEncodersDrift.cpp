@@ -144,6 +144,11 @@ bool OpticalEncodersDrift::setup(yarp::os::Property& property) {
     home.resize (n_cmd_joints); for (int i=0; i< n_cmd_joints; i++) home[i]=homeBottle->get(i).asFloat64();
     speed.resize(n_cmd_joints); for (int i=0; i< n_cmd_joints; i++) speed[i]=speedBottle->get(i).asFloat64();
 
+    std::vector<int> joints;
+    for (int i=0; i <n_cmd_joints; i++) joints.push_back((int)jointsList[i]);
+    ROBOTTESTINGFRAMEWORK_ASSERT_ERROR_IF_FALSE(controlBoard.configure(dd, joints), controlBoard.getError());
+    scheduler.setPeriod(0.010);
+
     return true;
 }
 
@@ -154,80 +159,25 @@ void OpticalEncodersDrift::tearDown()
 
 void OpticalEncodersDrift::setMode(int desired_mode)
 {
-    for (unsigned int i=0; i<jointsList.size(); i++)
-    {
-        icmd->setControlMode((int)jointsList[i],desired_mode);
-        iimd->setInteractionMode((int)jointsList[i],VOCAB_IM_STIFF);
-        yarp::os::Time::delay(0.010);
-    }
-
-    int cmode;
-    yarp::dev::InteractionModeEnum imode;
-    int timeout = 0;
-
-    while (1)
-    {
-        int ok=0;
-        for (unsigned int i=0; i<jointsList.size(); i++)
-        {
-            icmd->getControlMode ((int)jointsList[i],&cmode);
-            iimd->getInteractionMode((int)jointsList[i],&imode);
-            if (cmode==desired_mode && imode==VOCAB_IM_STIFF) ok++;
-        }
-        if (ok==jointsList.size()) break;
-        if (timeout>100)
-        {
-            ROBOTTESTINGFRAMEWORK_ASSERT_ERROR("Unable to set control mode/interaction mode");
-        }
-        yarp::os::Time::delay(0.2);
-        timeout++;
-    }
+    ROBOTTESTINGFRAMEWORK_ASSERT_ERROR_IF_FALSE(controlBoard.setAndVerifyModes(desired_mode,VOCAB_IM_STIFF),
+                                                "Unable to set control mode/interaction mode: "+controlBoard.getError());
 }
 
 bool OpticalEncodersDrift::goHome()
 {
-    for (unsigned int i=0; i<jointsList.size(); i++)
+    std::vector<double> positions(home.data(), home.data()+home.size());
+    std::vector<double> speeds(speed.data(), speed.data()+speed.size());
+    if (!controlBoard.goHome(positions, speeds, tolerance, 20.0))
     {
-        ipos->setRefSpeed((int)jointsList[i],speed[i]);
-        ipos->positionMove((int)jointsList[i],home[i]);
-    }
-
-    int timeout = 0;
-    while (1)
-    {
-        int in_position=0;
-        for (unsigned int i=0; i<jointsList.size(); i++)
-        {
-            double tmp=0;
-            ienc->getEncoder((int)jointsList[i],&tmp);
-            if (fabs(tmp-home[i])<tolerance) in_position++;
-        }
-        if (in_position==jointsList.size()) break;
-        if (timeout>100)
-        {
-            ROBOTTESTINGFRAMEWORK_TEST_REPORT("Timeout while reaching home position");
-            return false;
-        }
-        yarp::os::Time::delay(0.2);
-        timeout++;
+        ROBOTTESTINGFRAMEWORK_TEST_REPORT("Timeout while reaching home position: "+controlBoard.getError());
+        return false;
     }
     return true;
 }
 
 void OpticalEncodersDrift::saveToFile(std::string filename, yarp::os::Bottle &b)
 {
-    std::fstream fs;
-    fs.open (filename.c_str(), std::fstream::out);
-
-    for (unsigned int i=0; i<b.size(); i++)
-    {
-        std::string s = b.get(i).toString();
-        std::replace(s.begin(), s.end(), '(', ' ');
-        std::replace(s.begin(), s.end(), ')', ' ');
-        fs << s << std::endl;
-    }
-
-    fs.close();
+    ControlBoardHelper::saveToFile(filename, b);
 }
 
 void OpticalEncodersDrift::run()
@@ -246,6 +196,7 @@ void OpticalEncodersDrift::run()
     Bottle dataToPlot;
 
     imot->getMotorEncoders             (home_enc_mot.data());
+    scheduler.start();
     while(1)
     {
         double curr_time = yarp::os::Time::now();
@@ -310,8 +261,9 @@ void OpticalEncodersDrift::run()
 
         if (curr_cycle>=cycles) break;
 
-        yarp::os::Time::delay(0.010);
+        scheduler.waitNext();
     }
+    ROBOTTESTINGFRAMEWORK_TEST_REPORT(scheduler.report());
 
     bool isInHome = goHome();
     yarp::os::Time::delay(2.0);
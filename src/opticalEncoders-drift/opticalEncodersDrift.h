@@ -25,6 +25,8 @@
 #include <yarp/robottestingframework/TestCase.h>
 #include <yarp/dev/ControlBoardInterfaces.h>
 #include <yarp/dev/PolyDriver.h>
+#include "ControlBoardHelper.h"
+#include "FixedRateScheduler.h"
 #include <yarp/sig/Vector.h>
 #include <yarp/os/Bottle.h>
 #include <yarp/sig/Matrix.h>
@@ -88,6 +90,8 @@ private:
     yarp::dev::IControlMode     *icmd;
     yarp::dev::IInteractionMode  *iimd;
     yarp::dev::IEncoders         *ienc;
+    ControlBoardHelper           controlBoard;
+    FixedRateScheduler           scheduler;
     yarp::dev::IMotorEncoders    *imot;
 
     yarp::sig::Vector enc_jnt;
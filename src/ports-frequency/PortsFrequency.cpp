@@ -19,6 +19,8 @@
  */
 
 #include <math.h>
+#include <stdlib.h>
+#include <ctime>
 #include <robottestingframework/dll/Plugin.h>
 #include <robottestingframework/TestAssert.h>
 #include "PortsFrequency.h"
@@ -47,6 +49,21 @@ bool PortsFrequency::setup(yarp::os::Property &property) {
 
     // updating parameters
    testTime = (property.check("time")) ? property.find("time").asFloat64() : 2;
+   concurrent = (property.check("concurrent")) ? property.find("concurrent").asBool() : false;
+   maxBandwidth = (property.check("max_bandwidth")) ? property.find("max_bandwidth").asFloat64() : 0;
+   soakTime = (property.check("soak_time")) ? property.find("soak_time").asFloat64() : 0;
+   soakWindow = (property.check("window")) ? property.find("window").asFloat64() : 10;
+   soakHistory = (property.check("history")) ? property.find("history").asInt32() : 60;
+   soakOutput = (property.check("output")) ? property.find("output").asString() : "";
+   toleratedViolations = (property.check("tolerated_violations")) ? property.find("tolerated_violations").asInt32() : 0;
+   carriersParallel = (property.check("carriers_parallel")) ? property.find("carriers_parallel").asBool() : false;
+   if(property.check("carriers")) {
+       yarp::os::Bottle* btcarriers = property.find("carriers").asList();
+       ROBOTTESTINGFRAMEWORK_ASSERT_ERROR_IF_FALSE(btcarriers, "The carriers must be given as a list, e.g. (tcp udp)");
+       for(unsigned int i=0; i<btcarriers->size(); i++)
+           carriers.push_back(btcarriers->get(i).asString());
+   }
+   std::string probe = (property.check("probe")) ? property.find("probe").asString() : "bottle";
 
     ROBOTTESTINGFRAMEWORK_ASSERT_ERROR_IF_FALSE(property.check("PORTS"),
                         "A list of the ports must be given");
@@ -59,72 +76,433 @@ bool PortsFrequency::setup(yarp::os::Property &property) {
         info.name = btport->get(0).asString();
         info.frequency = btport->get(1).asInt32();
         info.tolerance = btport->get(2).asInt32();
+        info.probe = probe;
+        for(unsigned int j=3; j<btport->size(); j++) {
+            yarp::os::Bottle* btthr = btport->get(j).asList();
+            ROBOTTESTINGFRAMEWORK_ASSERT_ERROR_IF_FALSE(btthr && btthr->size()>=2,
+                                "The port options must be given as lists of <key> <value>");
+            std::string key = btthr->get(0).asString();
+            if(key == "probe") {
+                info.probe = btthr->get(1).asString();
+                continue;
+            }
+            size_t pos = key.rfind("_p");
+            ROBOTTESTINGFRAMEWORK_ASSERT_ERROR_IF_FALSE(pos != std::string::npos,
+                                Asserter::format("Invalid percentile threshold %s", key.c_str()));
+            PercentileThreshold thr;
+            thr.quantity = key.substr(0, pos);
+            thr.percentile = atof(key.substr(pos+2).c_str());
+            thr.maxValue = btthr->get(1).asFloat64();
+            ROBOTTESTINGFRAMEWORK_ASSERT_ERROR_IF_FALSE(thr.quantity == "period" ||
+                                thr.quantity == "sender_period" ||
+                                thr.quantity == "delay" ||
+                                thr.quantity == "latency",
+                                Asserter::format("Unknown quantity %s (use period, sender_period, delay or latency)", thr.quantity.c_str()));
+            ROBOTTESTINGFRAMEWORK_ASSERT_ERROR_IF_FALSE(thr.percentile > 0 && thr.percentile <= 100,
+                                Asserter::format("Invalid percentile in %s", key.c_str()));
+            info.percentiles.push_back(thr);
+        }
+        ROBOTTESTINGFRAMEWORK_ASSERT_ERROR_IF_FALSE(info.probe == "bottle" || info.probe == "envelope",
+                            Asserter::format("Unknown probe %s (use bottle or envelope)", info.probe.c_str()));
         ports.push_back(info);
     }
 
-    // opening port
-    ROBOTTESTINGFRAMEWORK_ASSERT_ERROR_IF_FALSE(port.open("..."),
-                        "opening port, is YARP network available?");
+    // opening ports
+    for(unsigned int i=0; i<ports.size(); i++) {
+        StreamProbe* dport = createProbe(ports[i]);
+        dataPorts.push_back(dport);
+        ROBOTTESTINGFRAMEWORK_ASSERT_ERROR_IF_FALSE(dport->openProbe("..."),
+                            "opening port, is YARP network available?");
+    }
     return true;
 }
 
+StreamProbe* PortsFrequency::createProbe(const MyPortInfo& info) {
+    if(info.probe == "envelope")
+        return new EnvelopePort;
+    return new DataPort;
+}
+
 void PortsFrequency::tearDown() {
     // finalization goes her ...
-    port.close();
+    for(unsigned int i=0; i<dataPorts.size(); i++) {
+        dataPorts[i]->closeProbe();
+        delete dataPorts[i];
+    }
+    dataPorts.clear();
 }
 
 void PortsFrequency::run() {
+    totalBandwidth = 0.0;
+    if(soakTime > 0) {
+        runSoak();
+        return;
+    }
+    if(!carriers.empty()) {
+        runCarriers();
+        return;
+    }
+    if(concurrent)
+        runConcurrent();
+    else
+        runSequential();
+    checkBandwidth();
+}
+
+void PortsFrequency::checkBandwidth() {
+    ROBOTTESTINGFRAMEWORK_TEST_REPORT("");
+    ROBOTTESTINGFRAMEWORK_TEST_REPORT(Asserter::format("Total received bandwidth %.3f MB/s",
+                                     totalBandwidth/1.0e6));
+    if(maxBandwidth > 0) {
+        ROBOTTESTINGFRAMEWORK_TEST_FAIL_IF_FALSE(totalBandwidth/1.0e6 <= maxBandwidth,
+                       Asserter::format("Total bandwidth is higher than the budget of %.3f MB/s",
+                                        maxBandwidth));
+    }
+}
+
+void PortsFrequency::runSequential() {
     for(unsigned int i=0; i<ports.size(); i++) {
         ROBOTTESTINGFRAMEWORK_TEST_REPORT("");
+        StreamProbe& port = *dataPorts[i];
         port.reset();
         ROBOTTESTINGFRAMEWORK_TEST_REPORT(Asserter::format("Checking port %s ...", ports[i].name.c_str()));
-        bool connected = Network::connect(ports[i].name.c_str(), port.getName());
+        if(connectPort(ports[i], port)) {
+            port.startProbe();
+            Time::delay(testTime);
+            port.stopProbe();
+            checkPort(ports[i], port);
+            Network::disconnect(ports[i].name.c_str(), port.getProbeName());
+        }
+    }
+}
+
+void PortsFrequency::runConcurrent() {
+    ROBOTTESTINGFRAMEWORK_TEST_REPORT(Asserter::format("Checking %d ports concurrently for %.2f s ...",
+                                     (int)ports.size(), testTime));
+    std::vector<bool> connected(ports.size(), false);
+    for(unsigned int i=0; i<ports.size(); i++) {
+        dataPorts[i]->reset();
+        connected[i] = connectPort(ports[i], *dataPorts[i]);
+    }
+
+    // all the readers share the same measurement window
+    for(unsigned int i=0; i<ports.size(); i++)
+        if(connected[i])
+            dataPorts[i]->startProbe();
+    Time::delay(testTime);
+    for(unsigned int i=0; i<ports.size(); i++)
+        if(connected[i])
+            dataPorts[i]->stopProbe();
+
+    for(unsigned int i=0; i<ports.size(); i++) {
+        if(!connected[i])
+            continue;
+        ROBOTTESTINGFRAMEWORK_TEST_REPORT("");
+        ROBOTTESTINGFRAMEWORK_TEST_REPORT(Asserter::format("Port %s:", ports[i].name.c_str()));
+        checkPort(ports[i], *dataPorts[i]);
+        Network::disconnect(ports[i].name.c_str(), dataPorts[i]->getProbeName());
+    }
+}
+
+bool PortsFrequency::connectPort(const MyPortInfo& info, StreamProbe& dport,
+                                 const std::string& carrier, bool required) {
+    bool connected = Network::connect(info.name.c_str(), dport.getProbeName(), carrier);
+    if(required)
         ROBOTTESTINGFRAMEWORK_TEST_FAIL_IF_FALSE(connected,
-                       Asserter::format("could not connect to remote port %s.", ports[i].name.c_str()));
-        if(connected) {
-            // setting QOS
-            QosStyle qos;
-            qos.setPacketPriorityByLevel(QosStyle::PacketPriorityHigh);
-            qos.setThreadPriority(30);
-            qos.setThreadPolicy(1);
-            Network::setConnectionQos(ports[i].name.c_str(), port.getName(), qos);
-            port.useCallback();
+                   Asserter::format("could not connect to remote port %s%s%s.", info.name.c_str(),
+                                    (carrier.empty()) ? "" : " with carrier ", carrier.c_str()));
+    if(connected) {
+        // setting QOS
+        QosStyle qos;
+        qos.setPacketPriorityByLevel(QosStyle::PacketPriorityHigh);
+        qos.setThreadPriority(30);
+        qos.setThreadPolicy(1);
+        Network::setConnectionQos(info.name.c_str(), dport.getProbeName(), qos);
+    }
+    return connected;
+}
+
+void PortsFrequency::checkPort(const MyPortInfo& info, StreamProbe& dport) {
+    if(dport.getSAvg() <= 0) {
+        ROBOTTESTINGFRAMEWORK_TEST_REPORT("Sender frequency is not available");
+    }
+    else {
+        ROBOTTESTINGFRAMEWORK_TEST_REPORT(Asserter::format("Time delay between sender/receiver is %.4f s. (min: %.4f, max: %.f4)",
+                        dport.getDAvg(), dport.getDMax(), dport.getDMin()));
+        ROBOTTESTINGFRAMEWORK_TEST_REPORT(Asserter::format("Sender frequency %d hrz. (min: %d, max: %d)",
+                                         (int)(1.0/dport.getSAvg()), (int)(1.0/dport.getSMax()), (int)(1.0/dport.getSMin())));
+    }
+    double freq = 1.0/dport.getAvg();
+    ROBOTTESTINGFRAMEWORK_TEST_REPORT(Asserter::format("Receiver frequency %d hrz. (min: %d, max: %d)",
+                    (int)freq, (int)(1.0/dport.getMax()), (int)(1.0/dport.getMin())));
+    double diff = fabs(freq - info.frequency);
+    ROBOTTESTINGFRAMEWORK_TEST_FAIL_IF_FALSE(diff < info.tolerance,
+                   Asserter::format("Receiver frequency is outside the desired range [%d .. %d]",
+                                    info.frequency-info.tolerance,
+                                    info.frequency+info.tolerance));
+    ROBOTTESTINGFRAMEWORK_TEST_REPORT(Asserter::format("Lost %ld packets. received (%ld)",
+                                     dport.getPacketLostCount(), dport.getCount()));
+    const SequenceAnalyzer& seq = dport.getSequence();
+    if(dport.getSPeriods().getCount() > 0) {
+        ROBOTTESTINGFRAMEWORK_TEST_REPORT(Asserter::format("Loss bursts %s (longest: %lu). Reordered %lu, repeated %lu, stale %lu, counter wraps %lu, restarts %lu",
+                                         seq.burstsToString().c_str(), seq.getMaxBurst(),
+                                         seq.getReordered(), seq.getRepeated(), seq.getStale(),
+                                         seq.getWraps(), seq.getRestarts()));
+    }
+
+    double bandwidth = dport.getBytes()/testTime;
+    totalBandwidth += bandwidth;
+    ROBOTTESTINGFRAMEWORK_TEST_REPORT(Asserter::format("Received %.1f kB/s. Message size %lu bytes (min: %lu, max: %lu)",
+                                     bandwidth/1.0e3, (unsigned long)dport.getAvgSize(),
+                                     (unsigned long)dport.getMinSize(), (unsigned long)dport.getMaxSize()));
+
+    reportPercentiles("Receiver period", dport.getPeriods());
+    if(dport.getSPeriods().getCount() > 0) {
+        reportPercentiles("Sender period", dport.getSPeriods());
+        reportPercentiles("Time delay", dport.getDelays());
+        ROBOTTESTINGFRAMEWORK_TEST_REPORT(Asserter::format("Estimated clock offset receiver-sender %.6f s (drift: %.2f ppm)",
+                                         dport.getClockOffset(), dport.getClockDrift()*1.0e6));
+        reportPercentiles("Latency", dport.getLatencies());
+    }
+
+    std::string violation = checkPercentiles(info, dport);
+    ROBOTTESTINGFRAMEWORK_TEST_FAIL_IF_FALSE(violation.empty(), violation);
+}
+
+std::string PortsFrequency::checkPercentiles(const MyPortInfo& info, StreamProbe& dport) {
+    std::string violation;
+    for(unsigned int i=0; i<info.percentiles.size(); i++) {
+        const PercentileThreshold& thr = info.percentiles[i];
+        const Histogram& hist = dport.getHistogram(thr.quantity);
+        // no samples (e.g. no time stamp): nothing to check
+        if(hist.getCount() == 0)
+            continue;
+        double value = hist.getPercentile(thr.percentile);
+        if(value > thr.maxValue) {
+            violation += (violation.empty()) ? "" : "; ";
+            violation += Asserter::format("%s p%g is %.4f s, higher than %.4f s",
+                                          thr.quantity.c_str(), thr.percentile, value, thr.maxValue);
+        }
+    }
+    return violation;
+}
+
+void PortsFrequency::runSoak() {
+    ROBOTTESTINGFRAMEWORK_TEST_REPORT(Asserter::format("Soak test of %d ports for %.0f s with windows of %.1f s ...",
+                                     (int)ports.size(), soakTime, soakWindow));
+
+    std::fstream fs;
+    if(!soakOutput.empty()) {
+        fs.open(soakOutput.c_str(), std::fstream::out);
+        ROBOTTESTINGFRAMEWORK_TEST_CHECK(fs.is_open(),
+                       Asserter::format("opening %s", soakOutput.c_str()));
+        for(unsigned int i=0; i<ports.size(); i++)
+            fs << "# port " << i << " " << ports[i].name << std::endl;
+        fs << "# start(s) port count frequency(Hz) period_p99(s) period_max(s) latency_p99(s) lost bytes violation" << std::endl;
+    }
+
+    std::vector<bool> connected(ports.size(), false);
+    std::vector< RingBuffer<SoakWindow> > history(ports.size());
+    std::vector<unsigned int> violations(ports.size(), 0);
+    std::vector<double> minFrequency(ports.size(), -1.0);
+    for(unsigned int i=0; i<ports.size(); i++) {
+        history[i].setCapacity(soakHistory);
+        dataPorts[i]->reset();
+        connected[i] = connectPort(ports[i], *dataPorts[i]);
+        if(connected[i])
+            dataPorts[i]->startProbe();
+    }
+
+    double tstart = Time::now();
+    double twindow = tstart;
+    unsigned int windows = (unsigned int)ceil(soakTime/soakWindow);
+    for(unsigned int w=0; w<windows; w++) {
+        // sleep until an absolute deadline, so that the windows do not drift
+        double tnext = tstart + (w+1)*soakWindow;
+        double tnow = Time::now();
+        if(tnext > tnow)
+            Time::delay(tnext - tnow);
+        tnow = Time::now();
+
+        for(unsigned int i=0; i<ports.size(); i++) {
+            if(!connected[i])
+                continue;
+            SoakWindow win = collectWindow(ports[i], *dataPorts[i], twindow-tstart, tnow-twindow);
+            history[i].push(win);
+            minFrequency[i] = (minFrequency[i] < 0 || win.frequency < minFrequency[i]) ? win.frequency : minFrequency[i];
+            if(win.violation) {
+                violations[i]++;
+                ROBOTTESTINGFRAMEWORK_TEST_REPORT(Asserter::format("[%.0f s] %s: %.1f Hz, period p99 %.4f s (max: %.4f), lost %lu",
+                                                 win.start, ports[i].name.c_str(), win.frequency,
+                                                 win.periodP99, win.periodMax, win.lost));
+            }
+            if(fs.is_open())
+                fs << win.start << " " << i << " " << win.count << " " << win.frequency << " "
+                   << win.periodP99 << " " << win.periodMax << " " << win.latencyP99 << " "
+                   << win.lost << " " << win.bytes << " " << win.violation << std::endl;
+        }
+        twindow = tnow;
+    }
+
+    for(unsigned int i=0; i<ports.size(); i++) {
+        if(!connected[i])
+            continue;
+        dataPorts[i]->stopProbe();
+        Network::disconnect(ports[i].name.c_str(), dataPorts[i]->getProbeName());
+
+        // trend over the windows still in memory
+        double recent = 0.0;
+        for(size_t k=0; k<history[i].size(); k++)
+            recent += history[i][k].frequency;
+        recent = (history[i].size() > 0) ? recent/history[i].size() : 0.0;
+
+        ROBOTTESTINGFRAMEWORK_TEST_REPORT("");
+        ROBOTTESTINGFRAMEWORK_TEST_REPORT(Asserter::format("Port %s: %u windows out of %u violate the bounds. Lowest frequency %.1f Hz, average over the last %d windows %.1f Hz",
+                                         ports[i].name.c_str(), violations[i], windows,
+                                         minFrequency[i], (int)history[i].size(), recent));
+        ROBOTTESTINGFRAMEWORK_TEST_FAIL_IF_FALSE(violations[i] <= toleratedViolations,
+                       Asserter::format("%u windows of %s violate the bounds (tolerated: %u)",
+                                        violations[i], ports[i].name.c_str(), toleratedViolations));
+    }
+}
+
+void PortsFrequency::runCarriers() {
+    for(unsigned int i=0; i<ports.size(); i++) {
+        ROBOTTESTINGFRAMEWORK_TEST_REPORT("");
+        ROBOTTESTINGFRAMEWORK_TEST_REPORT(Asserter::format("Benchmarking carriers for port %s ...", ports[i].name.c_str()));
+
+        // one reader per carrier, so that they can also be measured in parallel
+        std::vector<StreamProbe*> probes;
+        std::vector<bool> connected(carriers.size(), false);
+        std::vector<double> cpuUsage(carriers.size(), 0.0);
+        for(unsigned int c=0; c<carriers.size(); c++) {
+            probes.push_back(createProbe(ports[i]));
+            ROBOTTESTINGFRAMEWORK_TEST_CHECK(probes[c]->openProbe("..."), "opening port");
+        }
+
+        for(unsigned int c=0; c<carriers.size(); c++) {
+            probes[c]->reset();
+            // a carrier which is not available is reported but does not fail the test
+            connected[c] = connectPort(ports[i], *probes[c], carriers[c], false);
+            if(!connected[c]) {
+                ROBOTTESTINGFRAMEWORK_TEST_REPORT(Asserter::format("Carrier %s is not available", carriers[c].c_str()));
+                continue;
+            }
+            if(carriersParallel)
+                continue;
+            std::clock_t cpuStart = std::clock();
+            probes[c]->startProbe();
+            Time::delay(testTime);
+            probes[c]->stopProbe();
+            cpuUsage[c] = (double)(std::clock() - cpuStart)/CLOCKS_PER_SEC/testTime;
+            Network::disconnect(ports[i].name, probes[c]->getProbeName());
+        }
+
+        if(carriersParallel) {
+            std::clock_t cpuStart = std::clock();
+            for(unsigned int c=0; c<carriers.size(); c++)
+                if(connected[c])
+                    probes[c]->startProbe();
             Time::delay(testTime);
-            port.disableCallback();
-            if(port.getSAvg() <= 0) {
-                ROBOTTESTINGFRAMEWORK_TEST_REPORT("Sender frequency is not available");
+            for(unsigned int c=0; c<carriers.size(); c++)
+                if(connected[c])
+                    probes[c]->stopProbe();
+            double cpu = (double)(std::clock() - cpuStart)/CLOCKS_PER_SEC/testTime;
+            for(unsigned int c=0; c<carriers.size(); c++) {
+                cpuUsage[c] = cpu;
+                if(connected[c])
+                    Network::disconnect(ports[i].name, probes[c]->getProbeName());
             }
-            else {
-                ROBOTTESTINGFRAMEWORK_TEST_REPORT(Asserter::format("Time delay between sender/receiver is %.4f s. (min: %.4f, max: %.f4)",
-                                port.getDAvg(), port.getDMax(), port.getDMin()));
-                ROBOTTESTINGFRAMEWORK_TEST_REPORT(Asserter::format("Sender frequency %d hrz. (min: %d, max: %d)",
-                                                 (int)(1.0/port.getSAvg()), (int)(1.0/port.getSMax()), (int)(1.0/port.getSMin())));
+        }
+
+        ROBOTTESTINGFRAMEWORK_TEST_REPORT("  carrier     rate(Hz)  latency p50(s)  p99(s)   p99.9(s)    lost   CPU(%)");
+        for(unsigned int c=0; c<carriers.size(); c++) {
+            if(connected[c]) {
+                StreamProbe& probe = *probes[c];
+                const Histogram& latency = (probe.getLatencies().getCount() > 0) ?
+                                            probe.getLatencies() : probe.getPeriods();
+                ROBOTTESTINGFRAMEWORK_TEST_REPORT(Asserter::format("  %-10s %9.1f  %14.5f %8.5f %10.5f %7lu %8.1f%s",
+                                                 carriers[c].c_str(), probe.getCount()/testTime,
+                                                 latency.getPercentile(50), latency.getPercentile(99),
+                                                 latency.getPercentile(99.9), probe.getPacketLostCount(),
+                                                 cpuUsage[c]*100.0,
+                                                 (probe.getLatencies().getCount() > 0) ? "" : " (no time stamp: receiver period)"));
             }
-            double freq = 1.0/port.getAvg();
-            ROBOTTESTINGFRAMEWORK_TEST_REPORT(Asserter::format("Receiver frequency %d hrz. (min: %d, max: %d)",
-                            (int)freq, (int)(1.0/port.getMax()), (int)(1.0/port.getMin())));
-            double diff = fabs(freq - ports[i].frequency);
-            ROBOTTESTINGFRAMEWORK_TEST_FAIL_IF_FALSE(diff < ports[i].tolerance,
-                           Asserter::format("Receiver frequency is outside the desired range [%d .. %d]",
-                                            ports[i].frequency-ports[i].tolerance,
-                                            ports[i].frequency+ports[i].tolerance));
-            ROBOTTESTINGFRAMEWORK_TEST_REPORT(Asserter::format("Lost %ld packets. received (%ld)",
-                                             port.getPacketLostCount(), port.getCount()));
-            Network::disconnect(ports[i].name.c_str(), port.getName());
+            probes[c]->closeProbe();
+            delete probes[c];
         }
+        if(carriersParallel)
+            ROBOTTESTINGFRAMEWORK_TEST_REPORT("  (the CPU usage is the one of all the carriers together)");
     }
 }
 
-void DataPort::onRead(yarp::os::Bottle& bot) {
+SoakWindow PortsFrequency::collectWindow(const MyPortInfo& info, StreamProbe& dport,
+                                         double start, double duration) {
+    SoakWindow win;
+    dport.lock();
+    win.start = start;
+    win.count = dport.getCount();
+    win.lost = dport.getPacketLostCount();
+    win.frequency = (duration > 0) ? win.count/duration : 0.0;
+    win.periodP99 = dport.getPeriods().getPercentile(99);
+    win.periodMax = dport.getPeriods().getMax();
+    win.latencyP99 = dport.getLatencies().getPercentile(99);
+    win.bytes = dport.getBytes();
+    win.violation = (fabs(win.frequency - info.frequency) >= info.tolerance) ||
+                    !checkPercentiles(info, dport).empty();
+    dport.resetWindow();
+    dport.unlock();
+    return win;
+}
+
+void PortsFrequency::reportPercentiles(const std::string& label, const Histogram& hist) {
+    ROBOTTESTINGFRAMEWORK_TEST_REPORT(Asserter::format("%s percentiles (s): p50 %.4f, p90 %.4f, p99 %.4f, p99.9 %.4f (max: %.4f)",
+                                     label.c_str(),
+                                     hist.getPercentile(50), hist.getPercentile(90),
+                                     hist.getPercentile(99), hist.getPercentile(99.9),
+                                     hist.getMax()));
+}
+
+void DataPort::onRead(SizedBottle& bot) {
     double tcurrent = Time::now();
     Stamp stm;
     bool hasTimeStamp = getEnvelope(stm);
+    update(tcurrent, stm, hasTimeStamp, bot.bytes);
+}
+
+bool EnvelopePort::read(yarp::os::ConnectionReader& connection) {
+    double tcurrent = Time::now();
+    Stamp stm;
+    bool hasTimeStamp = getEnvelope(stm);
+
+    // consume the payload without deserializing it
+    size_t size = connection.getSize();
+    size_t remaining = size;
+    while(remaining > 0) {
+        size_t len = (remaining < sizeof(scratch)) ? remaining : sizeof(scratch);
+        if(!connection.expectBlock(scratch, len))
+            break;
+        remaining -= len;
+    }
+
+    if(active)
+        update(tcurrent, stm, hasTimeStamp, size);
+    return true;
+}
+
+void StreamProbe::update(double tcurrent, yarp::os::Stamp& stm, bool hasTimeStamp, size_t size) {
+    std::lock_guard<std::mutex> guard(mutex);
+    bytes += size;
+    minSize = (count == 0 || size < minSize) ? size : minSize;
+    maxSize = (size > maxSize) ? size : maxSize;
 
-    if(count == 0) {
+    if(!started) {
         if(hasTimeStamp) {
             double tdiff = fabs(tcurrent - stm.getTime());
             dsum = dmax = dmin = tdiff;
-            prevPacketCount = stm.getCount();
+            delays.add(tdiff);
+            latencies.add(clock.add(stm.getTime(), tcurrent));
+            sequence.add(stm.getCount());
         }
     }
     else {
@@ -133,6 +511,7 @@ void DataPort::onRead(yarp::os::Bottle& bot) {
         sum += tdiff;
         max = (tdiff > max) ? tdiff : max;
         min = (min<0 || min > tdiff) ? tdiff : min;
+        periods.add(tdiff);
 
         // calculating statistics using time stamp
         if(hasTimeStamp) {
@@ -140,20 +519,22 @@ void DataPort::onRead(yarp::os::Bottle& bot) {
             ssum += tdiff;
             smax = (tdiff > smax) ? tdiff : smax;
             smin = (smin<0 || smin > tdiff) ? tdiff : smin;
+            speriods.add(tdiff);
 
             // calculating time delay
             double tdiff = fabs(tcurrent - stm.getTime());
             dsum += tdiff;
             dmax = (tdiff > dmax) ? tdiff : dmax;
             dmin = (dmin<0 || dmin > tdiff) ? tdiff : dmin;
+            delays.add(tdiff);
+            latencies.add(clock.add(stm.getTime(), tcurrent));
             // calculating packet losts
-            if(stm.getCount() > prevPacketCount)
-                packetLostCount += stm.getCount() - prevPacketCount - 1;
-            prevPacketCount = stm.getCount();
+            sequence.add(stm.getCount());
         }
     }
 
     count++;
+    started = true;
     tprev = tcurrent;
     if(hasTimeStamp)
         stprev = stm.getTime();
@@ -23,26 +23,99 @@
 
 #include <yarp/robottestingframework/TestCase.h>
 #include <yarp/os/BufferedPort.h>
+#include <yarp/os/Port.h>
+#include <yarp/os/PortReader.h>
+#include <yarp/os/ConnectionReader.h>
 #include <yarp/os/Bottle.h>
+#include <yarp/os/Stamp.h>
 #include <vector>
+#include <atomic>
+#include <mutex>
+#include <fstream>
+#include "Histogram.h"
+#include "RingBuffer.h"
+#include "ClockOffsetEstimator.h"
+#include "SequenceAnalyzer.h"
+
+class PercentileThreshold {
+public:
+    std::string quantity;       // "period", "sender_period", "delay" or "latency"
+    double percentile;
+    double maxValue;            // seconds
+};
 
 class MyPortInfo {
 public:
     std::string name;
     unsigned int frequency;
     unsigned int tolerance;
+    std::string probe;          // "bottle" or "envelope"
+    std::vector<PercentileThreshold> percentiles;
+};
+
+/**
+ * The statistics of one port over one window of the soak mode.
+ */
+class SoakWindow {
+public:
+    double start;               // seconds from the beginning of the soak
+    unsigned long count;
+    unsigned long lost;
+    double frequency;
+    double periodP99, periodMax;
+    double latencyP99;
+    unsigned long long bytes;
+    bool violation;
 };
 
 
-class DataPort : public yarp::os::BufferedPort<yarp::os::Bottle> {
+/**
+ * Statistics collected on a stream: receiver/sender period, sender/receiver
+ * delay and lost packets. The actual reading of the messages is left to the
+ * derived classes, which call update() for every received message.
+ */
+class StreamProbe {
 public:
+    StreamProbe() : sequence(16, yarp::os::Stamp().getMaxCount()+1) { reset(); }
+    virtual ~StreamProbe() {}
+
+    virtual bool openProbe(const std::string& name) = 0;
+    virtual void closeProbe() = 0;
+    virtual std::string getProbeName() = 0;
+    virtual void startProbe() = 0;
+    virtual void stopProbe() = 0;
+
     void reset() {
         max = smax = sum = ssum = dmax = dsum = 0.0;
         min = smin = dmin = -1.0;
         tprev = stprev = 0.0;
         count = 0;
-        prevPacketCount = 0;
-        packetLostCount = 0;
+        sequence.reset();
+        bytes = minSize = maxSize = 0;
+        periods.reset();
+        speriods.reset();
+        delays.reset();
+        latencies.reset();
+        clock.reset();
+        started = false;
+    }
+
+    /**
+     * Resets the statistics but keeps track of the last received message,
+     * so that the gap across two consecutive windows is still measured.
+     */
+    void resetWindow() {
+        bool wasStarted = started;
+        double t = tprev, st = stprev;
+        ClockOffsetEstimator c = clock;
+        SequenceAnalyzer seq = sequence;
+        reset();
+        clock = c;
+        sequence = seq;
+        sequence.resetCounters();
+        started = wasStarted;
+        tprev = t;
+        stprev = st;
     }
 
     double getMax() { return max; }
@@ -54,20 +127,162 @@ public:
     double getDMax() { return dmax; }
     double getDMin() { return dmin; }
     double getDAvg() { return dsum/count; }
-    unsigned long getPacketLostCount() { return packetLostCount; }
+    unsigned long getPacketLostCount() { return sequence.getLost(); }
+    const SequenceAnalyzer& getSequence() { return sequence; }
     unsigned long getCount() { return count; }
+    unsigned long long getBytes() { return bytes; }
+    size_t getMinSize() { return minSize; }
+    size_t getMaxSize() { return maxSize; }
+    double getAvgSize() { return (count>0) ? (double)bytes/count : 0.0; }
+    const Histogram& getPeriods() { return periods; }
+    const Histogram& getSPeriods() { return speriods; }
+    const Histogram& getDelays() { return delays; }
+    const Histogram& getLatencies() { return latencies; }
+    double getClockOffset() { return clock.getOffset(); }
+    double getClockDrift() { return clock.getDrift(); }
+    const Histogram& getHistogram(const std::string& quantity) {
+        return (quantity == "period") ? periods :
+               (quantity == "sender_period") ? speriods :
+               (quantity == "latency") ? latencies : delays;
+    }
 
-    virtual void onRead(yarp::os::Bottle& bot);
+    // the statistics are updated from the reader thread: hold the lock
+    // to read and reset them while the probe is running
+    void lock() { mutex.lock(); }
+    void unlock() { mutex.unlock(); }
+
+protected:
+    void update(double tcurrent, yarp::os::Stamp& stm, bool hasTimeStamp, size_t size);
 
 private:
-    unsigned long count, packetLostCount;
-    unsigned long prevPacketCount;
+    bool started;
+    unsigned long count;
     double tprev, stprev;
     double max, min, sum;       // receiver time
     double smax, smin, ssum;    // sender time
     double dmax, dmin, dsum;    // time delay
+    unsigned long long bytes;   // message size
+    size_t minSize, maxSize;
+    Histogram periods;          // receiver time
+    Histogram speriods;         // sender time
+    Histogram delays;           // time delay
+    Histogram latencies;        // time delay corrected for the clock offset
+    ClockOffsetEstimator clock;
+    SequenceAnalyzer sequence;  // lost, reordered and repeated packets
+    std::mutex mutex;
 };
 
+
+/**
+ * A Bottle which remembers the size of the message it was read from, as
+ * given by the connection, so that it need not be serialized again to
+ * measure it.
+ */
+class SizedBottle : public yarp::os::Bottle {
+public:
+    SizedBottle() : bytes(0) { }
+
+    using yarp::os::Bottle::read;
+    virtual bool read(yarp::os::ConnectionReader& connection) {
+        bytes = connection.getSize();
+        return yarp::os::Bottle::read(connection);
+    }
+
+    size_t bytes;
+};
+
+
+/**
+ * Reads the messages as Bottles. The message size is the size of the
+ * payload given by the connection.
+ */
+class DataPort : public yarp::os::BufferedPort<SizedBottle>, public StreamProbe {
+public:
+    virtual bool openProbe(const std::string& name) { return open(name); }
+    virtual void closeProbe() { close(); }
+    virtual std::string getProbeName() { return getName(); }
+    virtual void startProbe() { useCallback(); }
+    virtual void stopProbe() { disableCallback(); }
+
+    virtual void onRead(SizedBottle& bot);
+};
+
+
+/**
+ * Reads only the envelope of the messages and discards the payload
+ * without deserializing it, so that any type of port (e.g. images)
+ * can be probed at full rate.
+ */
+class EnvelopePort : public yarp::os::Port, public yarp::os::PortReader, public StreamProbe {
+public:
+    EnvelopePort() : active(false) { }
+
+    virtual bool openProbe(const std::string& name) { setReader(*this); return open(name); }
+    virtual void closeProbe() { close(); }
+    virtual std::string getProbeName() { return getName(); }
+    virtual void startProbe() { active = true; }
+    virtual void stopProbe() { active = false; }
+
+    virtual bool read(yarp::os::ConnectionReader& connection);
+
+private:
+    std::atomic<bool> active;
+    char scratch[65536];
+};
+
+/**
+* \ingroup icub-tests
+* Check the frequency, the sender/receiver delay and the lost packets of a list of ports.
+*
+*  Accepts the following parameters:
+* | Parameter name | Type   | Units | Default Value | Required | Description | Notes |
+* |:--------------:|:------:|:-----:|:-------------:|:--------:|:-----------:|:-----:|
+* | name           | string | -     | "PortsFrequency" | No    | The name of the test. | -     |
+* | time           | double | s     | 2             | No       | The duration of the measurement of each port. | - |
+* | concurrent     | bool   | -     | false         | No       | If true, all the ports are connected and measured at the same time, each one with its own reader. | The whole test then takes about `time` seconds instead of one `time` per port. |
+* | max_bandwidth  | double | MB/s  | -             | No       | The budget on the total bandwidth of all the ports; the test fails if the sum of the received bytes/s exceeds it. | In the sequential mode the sum of the bandwidths measured port by port is used. |
+* | probe          | string | -     | "bottle"      | No       | How the messages are read: `bottle` deserializes them as Bottles, `envelope` reads only the envelope and skips the payload. | Can be overridden for a single port with `(probe <type>)`. Use `envelope` for images and any other heavy or non-Bottle stream. |
+* | PORTS          | group  | -     | -             | Yes      | The list of ports given as `<portname> <frequency> <tolerance> [(<quantity>_p<percentile> <max>) ...]`. | frequency and tolerance are in Hz. See below for the optional percentile thresholds. |
+* | soak_time      | double | s     | -             | No       | If given, all the ports are monitored concurrently for this long (soak mode), see below. | - |
+* | window         | double | s     | 10            | No       | The length of each window of the soak mode. | - |
+* | history        | int    | -     | 60            | No       | How many windows of each port are kept in memory in the soak mode. | - |
+* | output         | string | -     | -             | No       | The file where the per-window time series of the soak mode is written. | One line per window and port. |
+* | tolerated_violations | int | -  | 0             | No       | The number of windows of each port that may violate the bounds in the soak mode. | - |
+* | carriers       | list   | -     | -             | No       | If given, each port is measured once for every carrier in the list (carrier benchmark mode), e.g. `(tcp udp fast_tcp shmem mcast)`. | - |
+* | carriers_parallel | bool | -    | false         | No       | If true, the carriers of a port are measured at the same time, each one with its own reader. | The CPU usage is then reported for all the carriers together. |
+*
+* The delay is the raw difference between the receiver clock and the sender time
+* stamp, so it includes the offset between the clocks of the two hosts. The offset
+* and its drift are estimated from the lower envelope of the delays (see
+* ClockOffsetEstimator) and the `latency` is the delay corrected for them, i.e. the
+* one-way latency in excess of the fastest message.
+*
+* In the carrier benchmark mode a matrix with the rate, the latency percentiles, the
+* lost packets and the CPU usage of the test process is reported for each carrier;
+* carriers which cannot be connected are skipped. Pointing it to a publisher on the same
+* machine (e.g. the StreamGenerator fixture) allows to run it entirely on localhost.
+*
+* The lost packets are computed from the counts of the time stamps, which are also
+* analyzed for bursts of lost packets (reported as `<burst length>:<occurrences>`),
+* reordered and repeated packets, and wrap-around of the counter.
+*
+* For each port the received bytes/s and the min/avg/max message size are reported.
+*
+* Receiver period, sender period and delay of each port are recorded in
+* log-bucketed histograms, and their 50th, 90th, 99th and 99.9th percentiles are reported.
+* Optional upper bounds (in seconds) on any percentile can be appended to a port entry,
+* where quantity is one of `period`, `sender_period`, `delay` or `latency`, e.g.
+* \verbatim
+* /icub/left_arm/stateExt:o   100   5   (period_p99 0.015) (delay_p99.9 0.005)
+* /icub/cam/left                30   5   (probe envelope)
+* \endverbatim
+*
+* In the soak mode the statistics are collected and reset every `window` seconds.
+* A window violates the bounds when its frequency is outside the tolerance or one of
+* the percentile thresholds is exceeded. Only the last `history` windows are kept in
+* memory, while the whole time series is streamed to `output`, so the memory does
+* not grow with the duration of the test.
+*/
 class PortsFrequency : public yarp::robottestingframework::TestCase {
 public:
     PortsFrequency();
@@ -80,9 +295,34 @@ public:
     virtual void run();
 
 private:
-    DataPort port;
+    void runSequential();
+    void runConcurrent();
+    void runSoak();
+    void runCarriers();
+    StreamProbe* createProbe(const MyPortInfo& info);
+    SoakWindow collectWindow(const MyPortInfo& info, StreamProbe& dport,
+                             double start, double duration);
+    bool connectPort(const MyPortInfo& info, StreamProbe& dport,
+                     const std::string& carrier="", bool required=true);
+    void checkPort(const MyPortInfo& info, StreamProbe& dport);
+    void checkBandwidth();
+    std::string checkPercentiles(const MyPortInfo& info, StreamProbe& dport);
+    void reportPercentiles(const std::string& label, const Histogram& hist);
+
+private:
+    std::vector<StreamProbe*> dataPorts;    // one reader per port
     std::vector<MyPortInfo> ports;
     double testTime;
+    bool concurrent;
+    double maxBandwidth;                    // MB/s, <= 0 if not given
+    double totalBandwidth;                  // bytes/s
+    double soakTime;                        // <= 0 if not in soak mode
+    double soakWindow;
+    unsigned int soakHistory;
+    std::string soakOutput;
+    unsigned int toleratedViolations;
+    std::vector<std::string> carriers;      // carrier benchmark mode if not empty
+    bool carriersParallel;
 };
 
 #endif //_PORTSFREQUENCY_H
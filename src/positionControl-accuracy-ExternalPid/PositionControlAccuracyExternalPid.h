@@ -25,6 +25,8 @@
 #include <yarp/robottestingframework/TestCase.h>
 #include <yarp/dev/ControlBoardInterfaces.h>
 #include <yarp/dev/PolyDriver.h>
+#include "FixedRateScheduler.h"
+#include "ControlBoardHelper.h"
 //#include <iCub/ctrl/math.h>
 #include <iCub/ctrl/pids.h>
 
@@ -81,6 +83,7 @@ private:
     int*        m_jointsList;
     int         m_cycles;
     double      m_sampleTime;
+    FixedRateScheduler m_scheduler;
     double*     m_zeros;
     double      m_step;
     int         m_n_part_joints;
@@ -92,6 +95,7 @@ private:
     yarp::dev::IControlMode     *icmd;
     yarp::dev::IInteractionMode  *iimd;
     yarp::dev::IEncoders         *ienc;
+    ControlBoardHelper           controlBoard;
     yarp::dev::IPositionDirect   *idir;
     yarp::dev::IPWMControl       *ipwm;
 
@@ -92,6 +92,7 @@ bool PositionControlAccuracy::setup(yarp::os::Property& property) {
 
     m_sampleTime = property.find("sampleTime").asFloat64();
     ROBOTTESTINGFRAMEWORK_ASSERT_ERROR_IF_FALSE(m_sampleTime>0, "invalid sampleTime");
+    m_scheduler.setPeriod(m_sampleTime);
 
     Property options;
     options.put("device", "remote_controlboard");
@@ -146,6 +147,9 @@ bool PositionControlAccuracy::setup(yarp::os::Property& property) {
         ipid->setPid(cj,m_new_pid);
     }*/
 
+    std::vector<int> joints(m_jointsList, m_jointsList+m_n_cmd_joints);
+    ROBOTTESTINGFRAMEWORK_ASSERT_ERROR_IF_FALSE(controlBoard.configure(dd, joints), controlBoard.getError());
+
     return true;
 }
 
@@ -159,61 +163,17 @@ void PositionControlAccuracy::tearDown()
 
 void PositionControlAccuracy::setMode(int desired_mode)
 {
-    for (int i = 0; i<m_n_cmd_joints; i++)
-    {
-        icmd->setControlMode(m_jointsList[i], desired_mode);
-        iimd->setInteractionMode(m_jointsList[i], VOCAB_IM_STIFF);
-        yarp::os::Time::delay(0.010);
-    }
-
-    int cmode;
-    yarp::dev::InteractionModeEnum imode;
-    int timeout = 0;
-
-    while (1)
-    {
-        int ok=0;
-        for (int i = 0; i<m_n_cmd_joints; i++)
-        {
-            icmd->getControlMode(m_jointsList[i], &cmode);
-            iimd->getInteractionMode(m_jointsList[i], &imode);
-            if (cmode==desired_mode && imode==VOCAB_IM_STIFF) ok++;
-        }
-        if (ok == m_n_cmd_joints) break;
-        if (timeout>100)
-        {
-            ROBOTTESTINGFRAMEWORK_ASSERT_ERROR("Unable to set control mode/interaction mode");
-        }
-        yarp::os::Time::delay(0.2);
-        timeout++;
-    }
+    ROBOTTESTINGFRAMEWORK_ASSERT_ERROR_IF_FALSE(controlBoard.setAndVerifyModes(desired_mode,VOCAB_IM_STIFF),
+                                                "Unable to set control mode/interaction mode: "+controlBoard.getError());
 }
 
 bool PositionControlAccuracy::goHome()
 {
-    for (int i = 0; i<m_n_cmd_joints; i++)
+    std::vector<double> positions(m_zeros, m_zeros+m_n_cmd_joints);
+    if (!controlBoard.goHome(positions, 20.0, m_home_tolerance, 20.0))
     {
-        ipos->setRefSpeed(m_jointsList[i], 20.0);
-        ipos->positionMove(m_jointsList[i], m_zeros[i]);
-    }
-
-    int timeout = 0;
-    while (1)
-    {
-        int in_position=0;
-        for (int i = 0; i<m_n_cmd_joints; i++)
-        {
-            ienc->getEncoder(m_jointsList[i], &m_encoders[m_jointsList[i]]);
-            if (fabs(m_encoders[m_jointsList[i]] - m_zeros[i])<m_home_tolerance) in_position++;
-        }
-        if (in_position == m_n_cmd_joints) break;
-        if (timeout>100)
-        {
-            ROBOTTESTINGFRAMEWORK_ASSERT_ERROR("Timeout while reaching zero position");
-            return false;
-        }
-        yarp::os::Time::delay(0.2);
-        timeout++;
+        ROBOTTESTINGFRAMEWORK_ASSERT_ERROR("Timeout while reaching zero position: "+controlBoard.getError());
+        return false;
     }
     //sleep some additional time to complete movement from m_home_tolerance to 0
     yarp::os::Time::delay(0.5);
@@ -247,6 +207,7 @@ void PositionControlAccuracy::run()
             yarp::os::Bottle      dataToPlotRaw;
             yarp::os::Bottle      dataToPlotSync;
 
+            m_scheduler.start();
             while (1)
             {
                 double curr_time = yarp::os::Time::now();
@@ -274,9 +235,11 @@ void PositionControlAccuracy::run()
                 b1.addFloat64(elapsed);
                 b1.addFloat64(m_encoders[m_jointsList[i]]);
                 b1.addFloat64(m_cmd_single);
-                yarp::os::Time::delay(m_sampleTime);
+                m_scheduler.waitNext();
             }
 
+            ROBOTTESTINGFRAMEWORK_TEST_REPORT(m_scheduler.report());
+
             //reorder data
             for (int t = 0; t < dataToPlotRaw.size(); t++)
             {
@@ -334,16 +297,5 @@ void PositionControlAccuracy::run()
 
 void PositionControlAccuracy::saveToFile(std::string filename, yarp::os::Bottle &b)
 {
-    std::fstream fs;
-    fs.open(filename.c_str(), std::fstream::out);
-
-    for (int i = 0; i<b.size(); i++)
-    {
-        std::string s = b.get(i).toString();
-        std::replace(s.begin(), s.end(), '(', ' ');
-        std::replace(s.begin(), s.end(), ')', ' ');
-        fs << s << std::endl;
-    }
-
-    fs.close();
+    ControlBoardHelper::saveToFile(filename, b);
 }
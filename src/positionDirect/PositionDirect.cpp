@@ -90,6 +90,7 @@ bool PositionDirect::setup(yarp::os::Property& property) {
 
     sampleTime = property.find("sampleTime").asFloat64();
     ROBOTTESTINGFRAMEWORK_ASSERT_ERROR_IF_FALSE(sampleTime>0,"invalid sampleTime");
+    scheduler.setPeriod(sampleTime);
 
     cmd_mode = (cmd_mode_t) property.find("cmdMode").asInt32();
     ROBOTTESTINGFRAMEWORK_ASSERT_ERROR_IF_FALSE(cmd_mode>=0 && cmd_mode<=2,"invalid cmdMode: can be 0=single_joint, 1=all_joints ,2=some_joints");
@@ -128,6 +129,9 @@ bool PositionDirect::setup(yarp::os::Property& property) {
     cmd_some=new double[n_cmd_joints];
     for (int i=0; i <n_cmd_joints; i++) jointsList[i]=jointsBottle->get(i).asInt32();
 
+    std::vector<int> joints(jointsList, jointsList+n_cmd_joints);
+    ROBOTTESTINGFRAMEWORK_ASSERT_ERROR_IF_FALSE(controlBoard.configure(dd, joints), controlBoard.getError());
+
     return true;
 }
 
@@ -139,34 +143,8 @@ void PositionDirect::tearDown()
 
 void PositionDirect::setMode(int desired_mode)
 {
-    for (int i=0; i<n_cmd_joints; i++)
-    {
-        icmd->setControlMode(jointsList[i],desired_mode);
-        iimd->setInteractionMode(jointsList[i],VOCAB_IM_STIFF);
-        yarp::os::Time::delay(0.010);
-    }
-
-    int cmode;
-    yarp::dev::InteractionModeEnum imode;
-    int timeout = 0;
-
-    while (1)
-    {
-        int ok=0;
-        for (int i=0; i<n_cmd_joints; i++)
-        {
-            icmd->getControlMode (jointsList[i],&cmode);
-            iimd->getInteractionMode(jointsList[i],&imode);
-            if (cmode==desired_mode && imode==VOCAB_IM_STIFF) ok++;
-        }
-        if (ok==n_cmd_joints) break;
-        if (timeout>100)
-        {
-            ROBOTTESTINGFRAMEWORK_ASSERT_ERROR("Unable to set control mode/interaction mode");
-        }
-        yarp::os::Time::delay(0.2);
-        timeout++;
-    }
+    ROBOTTESTINGFRAMEWORK_ASSERT_ERROR_IF_FALSE(controlBoard.setAndVerifyModes(desired_mode,VOCAB_IM_STIFF),
+                                                "Unable to set control mode/interaction mode: "+controlBoard.getError());
 }
 
 void PositionDirect::executeCmd()
@@ -204,29 +182,9 @@ void PositionDirect::executeCmd()
 
 void PositionDirect::goHome()
 {
-    for (int i=0; i<n_cmd_joints; i++)
-    {
-        ipos->setRefSpeed(jointsList[i],20.0);
-        ipos->positionMove(jointsList[i],zero);
-    }
-
-    int timeout = 0;
-    while (1)
-    {
-        int in_position=0;
-        for (int i=0; i<n_cmd_joints; i++)
-        {
-            ienc->getEncoder(jointsList[i],&pos_tot[jointsList[i]]);
-            if (fabs(pos_tot[jointsList[i]]-zero)<0.5) in_position++;
-        }
-        if (in_position==n_cmd_joints) break;
-        if (timeout>100)
-        {
-            ROBOTTESTINGFRAMEWORK_ASSERT_ERROR("Timeout while reaching zero position");
-        }
-        yarp::os::Time::delay(0.2);
-        timeout++;
-    }
+    std::vector<double> positions(n_cmd_joints, zero);
+    ROBOTTESTINGFRAMEWORK_ASSERT_ERROR_IF_FALSE(controlBoard.goHome(positions, 20.0, 0.5, 20.0),
+                                                "Timeout while reaching zero position: "+controlBoard.getError());
 }
 
 void PositionDirect::run()
@@ -238,6 +196,7 @@ void PositionDirect::run()
     double start_time = yarp::os::Time::now();
     const double max_step = 2.0;
     prev_cmd=cmd_single = amplitude*sin(0.0)+zero;
+    scheduler.start();
     while(1)
     {
         double curr_time = yarp::os::Time::now();
@@ -250,9 +209,10 @@ void PositionDirect::run()
         ienc->getEncoders(pos_tot);
         executeCmd();
         //printf("%+6.3f %f\n",elapsed, cmd);
-        yarp::os::Time::delay(sampleTime);
+        scheduler.waitNext();
         if (elapsed*frequency>cycles) break;
     }
+    ROBOTTESTINGFRAMEWORK_TEST_REPORT(scheduler.report());
 
     setMode(VOCAB_CM_POSITION);
     goHome();
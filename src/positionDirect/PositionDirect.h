@@ -25,6 +25,8 @@
 #include <yarp/robottestingframework/TestCase.h>
 #include <yarp/dev/ControlBoardInterfaces.h>
 #include <yarp/dev/PolyDriver.h>
+#include "ControlBoardHelper.h"
+#include "FixedRateScheduler.h"
 
 /**
 * \ingroup icub-tests
@@ -81,6 +83,7 @@ private:
     double cycles;
     double tolerance;
     double sampleTime;
+    FixedRateScheduler scheduler;
     double zero;
     int    n_part_joints;
     int    n_cmd_joints;
@@ -96,6 +99,7 @@ private:
     yarp::dev::IControlMode     *icmd;
     yarp::dev::IInteractionMode  *iimd;
     yarp::dev::IEncoders         *ienc;
+    ControlBoardHelper           controlBoard;
     yarp::dev::IPositionDirect   *idir;
 
     double  cmd_single;
@@ -0,0 +1,227 @@
+/*
+ * iCub Robot Unit Tests (Robot Testing Framework)
+ *
+ * Copyright (C) 2015-2019 Istituto Italiano di Tecnologia (IIT)
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+
+#include <cmath>
+#include <yarp/os/Property.h>
+#include <yarp/os/Time.h>
+#include "LatencyProbe.h"
+
+#if defined(__linux__)
+#include <pthread.h>
+#include <sched.h>
+#include <time.h>
+#include <sys/mman.h>
+#endif
+
+using namespace yarp::os;
+
+#if defined(__linux__)
+static inline double monotonicTime(const struct timespec& ts) {
+    return ts.tv_sec + ts.tv_nsec*1e-9;
+}
+
+static inline void addNanoseconds(struct timespec& ts, long ns) {
+    ts.tv_nsec += ns;
+    while(ts.tv_nsec >= 1000000000L) {
+        ts.tv_nsec -= 1000000000L;
+        ts.tv_sec++;
+    }
+}
+#endif
+
+
+LatencyResult::LatencyResult() :
+    realtime(false), pinned(false), count(0), overruns(0), skipped(0),
+    min(0.0), mean(0.0), max(0.0), p50(0.0), p99(0.0), p999(0.0), p9999(0.0) {
+}
+
+void LatencyResult::toBottle(Bottle& bottle) const {
+    bottle.clear();
+    bottle.addFloat64(config.rate);
+    bottle.addInt32(config.priority);
+    bottle.addInt32(config.cpu);
+    bottle.addInt32(realtime ? 1 : 0);
+    bottle.addInt32(pinned ? 1 : 0);
+    bottle.addInt32((int)count);
+    bottle.addInt32((int)overruns);
+    bottle.addFloat64(min);
+    bottle.addFloat64(mean);
+    bottle.addFloat64(max);
+    bottle.addFloat64(p50);
+    bottle.addFloat64(p99);
+    bottle.addFloat64(p999);
+    bottle.addFloat64(p9999);
+    bottle.addInt32((int)skipped);
+}
+
+bool LatencyResult::fromBottle(const Bottle& bottle) {
+    if(bottle.size() != 15)
+        return false;
+    config.rate = bottle.get(0).asFloat64();
+    config.priority = bottle.get(1).asInt32();
+    config.cpu = bottle.get(2).asInt32();
+    realtime = bottle.get(3).asInt32() != 0;
+    pinned = bottle.get(4).asInt32() != 0;
+    count = bottle.get(5).asInt32();
+    overruns = bottle.get(6).asInt32();
+    min = bottle.get(7).asFloat64();
+    mean = bottle.get(8).asFloat64();
+    max = bottle.get(9).asFloat64();
+    p50 = bottle.get(10).asFloat64();
+    p99 = bottle.get(11).asFloat64();
+    p999 = bottle.get(12).asFloat64();
+    p9999 = bottle.get(13).asFloat64();
+    skipped = bottle.get(14).asInt32();
+    return true;
+}
+
+
+LatencyThread::LatencyThread(const LatencyConfig& config, double duration) :
+    config(config), duration(duration), realtime(false), pinned(false),
+    latencies(1e-7, 1.0, 64), overruns(0), skipped(0) {
+}
+
+bool LatencyThread::threadInit() {
+#if defined(__linux__)
+    if(config.cpu >= 0) {
+        cpu_set_t set;
+        CPU_ZERO(&set);
+        CPU_SET(config.cpu, &set);
+        pinned = (pthread_setaffinity_np(pthread_self(), sizeof(set), &set) == 0);
+    }
+    if(config.priority > 0) {
+        struct sched_param param;
+        param.sched_priority = config.priority;
+        realtime = (pthread_setschedparam(pthread_self(), SCHED_FIFO, &param) == 0);
+    }
+#endif
+    return true;
+}
+
+void LatencyThread::run() {
+    double period = 1.0/config.rate;
+#if defined(__linux__)
+    const long periodNs = (long)(1e9*period);
+    struct timespec deadline, now;
+    clock_gettime(CLOCK_MONOTONIC, &deadline);
+    double end = monotonicTime(deadline) + duration;
+    addNanoseconds(deadline, periodNs);
+    while(!isStopping()) {
+        clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &deadline, NULL);
+        clock_gettime(CLOCK_MONOTONIC, &now);
+        double latency = monotonicTime(now) - monotonicTime(deadline);
+        latencies.add(latency > 0.0 ? latency : 0.0);
+        if(latency > period)
+            overruns++;
+        if(monotonicTime(now) >= end)
+            break;
+        // skip the deadlines already missed instead of catching up with them
+        addNanoseconds(deadline, periodNs);
+        while(monotonicTime(deadline) <= monotonicTime(now)) {
+            addNanoseconds(deadline, periodNs);
+            skipped++;
+        }
+    }
+#else
+    double deadline = Time::now();
+    double end = deadline + duration;
+    deadline += period;
+    while(!isStopping()) {
+        Time::delay(deadline - Time::now());
+        double now = Time::now();
+        double latency = now - deadline;
+        latencies.add(latency > 0.0 ? latency : 0.0);
+        if(latency > period)
+            overruns++;
+        if(deadline >= end)
+            break;
+        deadline += period;
+        while(deadline <= now) {
+            deadline += period;
+            skipped++;
+        }
+    }
+#endif
+}
+
+LatencyResult LatencyThread::getResult() const {
+    LatencyResult result;
+    result.config = config;
+    result.realtime = realtime;
+    result.pinned = pinned;
+    result.count = latencies.getCount();
+    result.overruns = overruns;
+    result.skipped = skipped;
+    result.min = latencies.getMin();
+    result.mean = latencies.getMean();
+    result.max = latencies.getMax();
+    result.p50 = latencies.getPercentile(50);
+    result.p99 = latencies.getPercentile(99);
+    result.p999 = latencies.getPercentile(99.9);
+    result.p9999 = latencies.getPercentile(99.99);
+    return result;
+}
+
+
+bool parseLatencyConfigs(const Bottle& threads, std::vector<LatencyConfig>& configs) {
+    configs.clear();
+    for(size_t i=0; i<threads.size(); i++) {
+        Bottle* btthread = threads.get(i).asList();
+        if(!btthread)
+            return false;
+        Property prop(btthread->toString().c_str());
+        LatencyConfig config;
+        config.rate = prop.check("rate") ? prop.find("rate").asFloat64() : config.rate;
+        config.priority = prop.check("priority") ? prop.find("priority").asInt32() : config.priority;
+        config.cpu = prop.check("cpu") ? prop.find("cpu").asInt32() : config.cpu;
+        if(config.rate <= 0)
+            return false;
+        configs.push_back(config);
+    }
+    return !configs.empty();
+}
+
+bool runLatencyThreads(const std::vector<LatencyConfig>& configs, double duration,
+                       bool lockMemory, std::vector<LatencyResult>& results) {
+#if defined(__linux__)
+    bool locked = lockMemory && (mlockall(MCL_CURRENT | MCL_FUTURE) == 0);
+#endif
+    std::vector<LatencyThread*> threads;
+    bool ok = true;
+    for(size_t i=0; i<configs.size(); i++) {
+        LatencyThread* thread = new LatencyThread(configs[i], duration);
+        threads.push_back(thread);
+        ok = thread->start() && ok;
+    }
+    // the threads stop by themselves at the end of the duration
+    for(size_t i=0; i<threads.size(); i++)
+        threads[i]->join();
+    results.clear();
+    for(size_t i=0; i<threads.size(); i++) {
+        results.push_back(threads[i]->getResult());
+        delete threads[i];
+    }
+#if defined(__linux__)
+    if(locked)
+        munlockall();
+#endif
+    return ok;
+}
@@ -0,0 +1,103 @@
+/*
+ * iCub Robot Unit Tests (Robot Testing Framework)
+ *
+ * Copyright (C) 2015-2019 Istituto Italiano di Tecnologia (IIT)
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+
+#ifndef _LATENCY_PROBE_H_
+#define _LATENCY_PROBE_H_
+
+#include <vector>
+#include <yarp/os/Thread.h>
+#include <yarp/os/Bottle.h>
+#include "Histogram.h"
+
+class LatencyConfig {
+public:
+    LatencyConfig() : rate(1000.0), priority(80), cpu(-1) { }
+    double rate;            // Hz
+    int priority;           // SCHED_FIFO priority, 0 for SCHED_OTHER
+    int cpu;                // -1 for no affinity
+};
+
+
+class LatencyResult {
+public:
+    LatencyResult();
+
+    LatencyConfig config;
+    bool realtime;          // SCHED_FIFO granted
+    bool pinned;            // affinity granted
+    unsigned long count;
+    unsigned long overruns; // wake-ups later than a whole period
+    unsigned long skipped;  // periods missed altogether after an overrun
+    double min, mean, max;
+    double p50, p99, p999, p9999;
+
+    /** (rate priority cpu realtime pinned count overruns min mean max p50 p99 p99.9 p99.99 skipped) */
+    void toBottle(yarp::os::Bottle& bottle) const;
+    bool fromBottle(const yarp::os::Bottle& bottle);
+};
+
+
+/**
+ * A periodic thread which measures how late it wakes up w.r.t. its deadlines,
+ * in the spirit of cyclictest: it sleeps until an absolute deadline on the
+ * monotonic clock and records the difference between the time it actually
+ * runs and the deadline in a histogram. After an overrun the deadlines
+ * already missed are skipped, as cyclictest does, so a stall is recorded
+ * once and not as a burst of late catch-up wake-ups.
+ *
+ * On Linux the thread is given the SCHED_FIFO policy with the configured
+ * priority and is pinned to the configured CPU; when this is not allowed
+ * (e.g. no rtprio in the limits of the user) it runs anyway and the result
+ * tells which settings were granted. On the other platforms it always runs
+ * with the default scheduler.
+ */
+class LatencyThread : public yarp::os::Thread {
+public:
+    LatencyThread(const LatencyConfig& config, double duration);
+
+    virtual bool threadInit();
+    virtual void run();
+
+    LatencyResult getResult() const;
+
+private:
+    LatencyConfig config;
+    double duration;
+    bool realtime, pinned;
+    Histogram latencies;
+    unsigned long overruns;
+    unsigned long skipped;
+};
+
+
+/**
+ * Parses a list of threads given as ((rate 1000) (priority 80) (cpu 1)) ...
+ */
+bool parseLatencyConfigs(const yarp::os::Bottle& threads, std::vector<LatencyConfig>& configs);
+
+/**
+ * Runs all the threads at the same time for the given duration and returns their results.
+ * @param lockMemory locks the memory of the process, to avoid page faults during the test
+ */
+bool runLatencyThreads(const std::vector<LatencyConfig>& configs, double duration,
+                       bool lockMemory, std::vector<LatencyResult>& results);
+
+#endif //_LATENCY_PROBE_H_
@@ -0,0 +1,158 @@
+/*
+ * iCub Robot Unit Tests (Robot Testing Framework)
+ *
+ * Copyright (C) 2015-2019 Istituto Italiano di Tecnologia (IIT)
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+
+#include <robottestingframework/dll/Plugin.h>
+#include <robottestingframework/TestAssert.h>
+#include <yarp/os/Network.h>
+#include <yarp/os/Port.h>
+#include <yarp/os/Bottle.h>
+#include <yarp/os/Time.h>
+#include <yarp/run/Run.h>
+#include "RtLatency.h"
+
+using namespace robottestingframework;
+using namespace yarp::os;
+
+#define HELPER_TIMEOUT      10.0        //seconds
+
+// prepare the plugin
+ROBOTTESTINGFRAMEWORK_PREPARE_PLUGIN(RtLatency)
+
+RtLatency::RtLatency() : yarp::robottestingframework::TestCase("RtLatency") {
+}
+
+RtLatency::~RtLatency() { }
+
+bool RtLatency::setup(yarp::os::Property& property) {
+
+    if(property.check("name"))
+        setName(property.find("name").asString());
+
+    Bottle threads("((rate 1000) (priority 80))");
+    if(property.check("threads")) {
+        Bottle* btthreads = property.find("threads").asList();
+        ROBOTTESTINGFRAMEWORK_ASSERT_ERROR_IF_FALSE(btthreads, "The threads must be given as lists of (rate ..) (priority ..) (cpu ..)");
+        threads = *btthreads;
+    }
+    ROBOTTESTINGFRAMEWORK_ASSERT_ERROR_IF_FALSE(parseLatencyConfigs(threads, configs),
+                        "The threads must be given as lists of (rate ..) (priority ..) (cpu ..), with a positive rate");
+    duration = property.check("duration") ? property.find("duration").asFloat64() : 10.0;
+    host = property.check("host") ? property.find("host").asString() : "";
+    helper = property.check("helper") ? property.find("helper").asString() : "rtLatencyProbe";
+    lockMemory = property.check("lock_memory") ? property.find("lock_memory").asBool() : true;
+    requireRealtime = property.check("require_realtime") ? property.find("require_realtime").asBool() : true;
+    maxLatency = property.check("max_latency") ? property.find("max_latency").asFloat64() : -1;
+    maxLatencyP9999 = property.check("max_latency_p9999") ? property.find("max_latency_p9999").asFloat64() : -1;
+    toleratedOverruns = property.check("tolerated_overruns") ? property.find("tolerated_overruns").asInt32() : -1;
+    return true;
+}
+
+void RtLatency::tearDown() {
+}
+
+bool RtLatency::runRemote(std::vector<LatencyResult>& results) {
+    std::string portName = "/rtLatencyProbe" + host;
+    Property command;
+    command.put("name", helper);
+    command.put("parameters", "--name " + portName);
+    std::string keyv;
+    ROBOTTESTINGFRAMEWORK_TEST_REPORT(Asserter::format("Launching %s on %s", helper.c_str(), host.c_str()));
+    if(yarp::run::Run::start(host, command, keyv) != 0) {
+        ROBOTTESTINGFRAMEWORK_TEST_FAIL_IF_FALSE(false, Asserter::format("Cannot launch %s on %s, is yarprun running?", helper.c_str(), host.c_str()));
+        return false;
+    }
+
+    double start = Time::now();
+    while(!Network::exists(portName) && Time::now() - start < HELPER_TIMEOUT)
+        Time::delay(0.1);
+
+    Port port;
+    bool ok = port.open("...");
+    ok = ok && Network::connect(port.getName(), portName);
+    if(ok) {
+        Bottle cmd, reply;
+        cmd.addString("run");
+        cmd.addFloat64(duration);
+        Bottle& btthreads = cmd.addList();
+        for(size_t i=0; i<configs.size(); i++) {
+            Bottle& btthread = btthreads.addList();
+            btthread.addList().fromString(Asserter::format("rate %f", configs[i].rate));
+            btthread.addList().fromString(Asserter::format("priority %d", configs[i].priority));
+            btthread.addList().fromString(Asserter::format("cpu %d", configs[i].cpu));
+        }
+        port.setTimeout(duration + HELPER_TIMEOUT);
+        ok = port.write(cmd, reply) && reply.get(0).asString() == "ok";
+        for(size_t i=1; ok && i<reply.size(); i++) {
+            LatencyResult result;
+            ok = reply.get(i).asList() && result.fromBottle(*reply.get(i).asList());
+            results.push_back(result);
+        }
+        ROBOTTESTINGFRAMEWORK_TEST_FAIL_IF_FALSE(ok, Asserter::format("Wrong reply from %s: %s", portName.c_str(), reply.toString().c_str()));
+        cmd.clear();
+        reply.clear();
+        cmd.addString("quit");
+        port.write(cmd, reply);
+    }
+    else
+        ROBOTTESTINGFRAMEWORK_TEST_FAIL_IF_FALSE(false, Asserter::format("Cannot connect to %s", portName.c_str()));
+    port.close();
+
+    if(yarp::run::Run::isRunning(host, keyv))
+        yarp::run::Run::sigterm(host, keyv);
+    return ok;
+}
+
+void RtLatency::run() {
+    std::vector<LatencyResult> results;
+    ROBOTTESTINGFRAMEWORK_TEST_REPORT(Asserter::format("Running %d periodic threads for %.1f seconds on %s",
+                                       (int)configs.size(), duration, host.empty() ? "the local host" : host.c_str()));
+    if(host.empty())
+        ROBOTTESTINGFRAMEWORK_TEST_FAIL_IF_FALSE(runLatencyThreads(configs, duration, lockMemory, results),
+                         "Cannot start the periodic threads");
+    else if(!runRemote(results))
+        return;
+
+    for(size_t i=0; i<results.size(); i++) {
+        const LatencyResult& result = results[i];
+        std::string label = Asserter::format("Thread %d (%.0f Hz, priority %d, cpu %d)", (int)i,
+                                             result.config.rate, result.config.priority, result.config.cpu);
+        ROBOTTESTINGFRAMEWORK_TEST_REPORT(Asserter::format("%s: %lu wake-ups, latency (us) min %.1f, mean %.1f, p50 %.1f, p99 %.1f, p99.9 %.1f, p99.99 %.1f, max %.1f, %lu overruns (%lu periods skipped)",
+                                           label.c_str(), result.count, result.min*1e6, result.mean*1e6,
+                                           result.p50*1e6, result.p99*1e6, result.p999*1e6, result.p9999*1e6,
+                                           result.max*1e6, result.overruns, result.skipped));
+        if(requireRealtime && result.config.priority > 0)
+            ROBOTTESTINGFRAMEWORK_TEST_FAIL_IF_FALSE(result.realtime,
+                             Asserter::format("%s: SCHED_FIFO not granted (check the rtprio limit)", label.c_str()));
+        if(requireRealtime && result.config.cpu >= 0)
+            ROBOTTESTINGFRAMEWORK_TEST_FAIL_IF_FALSE(result.pinned,
+                             Asserter::format("%s: cannot be pinned to the cpu", label.c_str()));
+        ROBOTTESTINGFRAMEWORK_TEST_FAIL_IF_FALSE(result.count > 0, Asserter::format("%s: never woke up", label.c_str()));
+        if(maxLatency > 0)
+            ROBOTTESTINGFRAMEWORK_TEST_FAIL_IF_FALSE(result.max <= maxLatency,
+                             Asserter::format("%s: maximum latency higher than %.1f us", label.c_str(), maxLatency*1e6));
+        if(maxLatencyP9999 > 0)
+            ROBOTTESTINGFRAMEWORK_TEST_FAIL_IF_FALSE(result.p9999 <= maxLatencyP9999,
+                             Asserter::format("%s: 99.99th percentile of the latency higher than %.1f us", label.c_str(), maxLatencyP9999*1e6));
+        if(toleratedOverruns >= 0)
+            ROBOTTESTINGFRAMEWORK_TEST_FAIL_IF_FALSE(result.overruns <= (unsigned long)toleratedOverruns,
+                             Asserter::format("%s: more than %d overruns", label.c_str(), toleratedOverruns));
+    }
+}
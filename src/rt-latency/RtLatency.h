@@ -0,0 +1,80 @@
+/*
+ * iCub Robot Unit Tests (Robot Testing Framework)
+ *
+ * Copyright (C) 2015-2019 Istituto Italiano di Tecnologia (IIT)
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+
+#ifndef _RT_LATENCY_H_
+#define _RT_LATENCY_H_
+
+#include <string>
+#include <vector>
+#include <yarp/robottestingframework/TestCase.h>
+#include "LatencyProbe.h"
+
+
+/**
+* \ingroup icub-tests
+* Checks that periodic real-time threads wake up on time on a host (cyclictest-style),
+* i.e. that the host and its limits (rtprio, memlock) are fit for the control loops.
+*
+*  Accepts the following parameters:
+* | Parameter name | Type   | Units | Default Value | Required | Description | Notes |
+* |:--------------:|:------:|:-----:|:-------------:|:--------:|:-----------:|:-----:|
+* | name           | string | -     | "RtLatency"   | No       | The name of the test. | - |
+* | threads        | lists  | -     | ((rate 1000) (priority 80)) | No | The threads, as lists of (rate <Hz>) (priority <SCHED_FIFO priority>) (cpu <index>). | A priority of 0 uses the default scheduler; without cpu the thread is not pinned. |
+* | duration       | double | s     | 10            | No       | The duration of the test. | - |
+* | host           | string | -     | -             | No       | If given, the yarprun on which the threads run, through the rtLatencyProbe helper; otherwise they run in the test process. | The helper must be in the PATH of the host. |
+* | helper         | string | -     | "rtLatencyProbe" | No    | The helper executable. | - |
+* | lock_memory    | bool   | -     | true          | No       | Locks the memory of the (local) process during the test. | The helper always does. |
+* | require_realtime | bool | -     | true          | No       | The test fails when the SCHED_FIFO priority or the affinity cannot be set. | - |
+* | max_latency    | double | s     | -             | No       | The maximum wake-up latency allowed. | - |
+* | max_latency_p9999 | double | s  | -             | No       | The maximum 99.99th percentile of the wake-up latency allowed. | - |
+* | tolerated_overruns | int | -    | -             | No       | The number of wake-ups later than a whole period tolerated. | The periods missed after an overrun are skipped and not counted again. |
+*
+* All the threads run at the same time. The wake-up latency is the time between the
+* absolute deadline (monotonic clock) and the time the thread actually runs; it is
+* recorded in a histogram with a relative resolution of about 1.5%.
+*/
+class RtLatency : public yarp::robottestingframework::TestCase {
+public:
+    RtLatency();
+    virtual ~RtLatency();
+
+    virtual bool setup(yarp::os::Property& property);
+
+    virtual void tearDown();
+
+    virtual void run();
+
+private:
+    bool runRemote(std::vector<LatencyResult>& results);
+
+private:
+    std::vector<LatencyConfig> configs;
+    double duration;
+    std::string host;
+    std::string helper;
+    bool lockMemory;
+    bool requireRealtime;
+    double maxLatency;
+    double maxLatencyP9999;
+    int toleratedOverruns;
+};
+
+#endif //_RT_LATENCY_H_
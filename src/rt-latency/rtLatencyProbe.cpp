@@ -0,0 +1,81 @@
+/*
+ * iCub Robot Unit Tests (Robot Testing Framework)
+ *
+ * Copyright (C) 2015-2019 Istituto Italiano di Tecnologia (IIT)
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+
+/**
+ * A small helper running the periodic threads of the RtLatency test on a
+ * remote host, where it is launched through yarprun. It opens an rpc port
+ * and serves the commands:
+ *  - run <duration> ((rate 1000) (priority 80) (cpu 1)) ...
+ *    runs the threads and replies with ok and the result of each thread;
+ *  - quit
+ */
+
+#include <cstdio>
+#include <yarp/os/Network.h>
+#include <yarp/os/Port.h>
+#include <yarp/os/Bottle.h>
+#include <yarp/os/Property.h>
+#include "LatencyProbe.h"
+
+using namespace yarp::os;
+
+int main(int argc, char* argv[]) {
+    Network yarp;
+    Property prop;
+    prop.fromCommand(argc, argv);
+    std::string name = prop.check("name") ? prop.find("name").asString() : "/rtLatencyProbe";
+
+    Port port;
+    if(!port.open(name)) {
+        printf("rtLatencyProbe: cannot open %s\n", name.c_str());
+        return 1;
+    }
+
+    while(true) {
+        Bottle cmd, reply;
+        if(!port.read(cmd, true))
+            break;
+        std::string command = cmd.get(0).asString();
+        if(command == "run" && cmd.size() == 3 && cmd.get(2).asList()) {
+            std::vector<LatencyConfig> configs;
+            std::vector<LatencyResult> results;
+            if(!parseLatencyConfigs(*cmd.get(2).asList(), configs))
+                reply.addString("wrong threads");
+            else {
+                bool ok = runLatencyThreads(configs, cmd.get(1).asFloat64(), true, results);
+                reply.addString(ok ? "ok" : "failed");
+                for(size_t i=0; i<results.size(); i++)
+                    results[i].toBottle(reply.addList());
+            }
+        }
+        else if(command == "quit") {
+            reply.addString("bye");
+            port.reply(reply);
+            break;
+        }
+        else
+            reply.addString("unknown command");
+        port.reply(reply);
+    }
+
+    port.close();
+    return 0;
+}
@@ -19,20 +19,60 @@
  */
 
 #include <math.h>
-#include <Plugin.h>
+#include <string.h>
+#include <robottestingframework/dll/Plugin.h>
+#include <robottestingframework/TestAssert.h>
 #include "SensorsDuplicateReadings.h"
 #include <yarp/os/Time.h>
 #include <yarp/os/Stamp.h>
-#include <yarp/math/Math.h>
+#include <yarp/os/Network.h>
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
 
 using namespace std;
 using namespace robottestingframework;
 using namespace yarp::os;
-using namespace yarp::math;
 
 // prepare the plugin
 ROBOTTESTINGFRAMEWORK_PREPARE_PLUGIN(SensorsDuplicateReadings)
 
+/**
+ * Returns true if the squared euclidean distance between a and b is below
+ * threshold. The sum is computed in blocks, vectorized where SSE2 is available,
+ * and it stops at the first block which exceeds the threshold: new readings
+ * are usually detected within the first few channels.
+ */
+static bool isCloserThan(const double* a, const double* b, size_t n, double threshold)
+{
+    const size_t block = 32;
+    double sum = 0.0;
+    size_t i = 0;
+    while(i < n) {
+        size_t end = (i+block < n) ? i+block : n;
+#if defined(__SSE2__)
+        __m128d acc0 = _mm_setzero_pd();
+        __m128d acc1 = _mm_setzero_pd();
+        for(; i+4 <= end; i+=4) {
+            __m128d d0 = _mm_sub_pd(_mm_loadu_pd(a+i), _mm_loadu_pd(b+i));
+            __m128d d1 = _mm_sub_pd(_mm_loadu_pd(a+i+2), _mm_loadu_pd(b+i+2));
+            acc0 = _mm_add_pd(acc0, _mm_mul_pd(d0, d0));
+            acc1 = _mm_add_pd(acc1, _mm_mul_pd(d1, d1));
+        }
+        double partial[2];
+        _mm_storeu_pd(partial, _mm_add_pd(acc0, acc1));
+        sum += partial[0] + partial[1];
+#endif
+        for(; i < end; i++) {
+            double d = a[i] - b[i];
+            sum += d*d;
+        }
+        if(!(sum < threshold))
+            return false;
+    }
+    return true;
+}
+
 SensorsDuplicateReadings::SensorsDuplicateReadings() : yarp::robottestingframework::TestCase("SensorsDuplicateReadings") {
 }
 
@@ -46,76 +86,184 @@ bool SensorsDuplicateReadings::setup(yarp::os::Property &property) {
 
     // updating parameters
    testTime = (property.check("time")) ? property.find("time").asFloat64() : 2;
+   double stuckTime = (property.check("stuck_time")) ? property.find("stuck_time").asFloat64() : 0;
+   double stuckTolerance = (property.check("stuck_tolerance")) ? property.find("stuck_tolerance").asFloat64() : 1e-12;
+   int toleratedStuckChannels = (property.check("tolerated_stuck_channels")) ? property.find("tolerated_stuck_channels").asInt32() : 0;
 
-    ROBOTTESTINGFRAMEWORK_ASSERT_ERROR_IF(property.check("PORTS"),
+    ROBOTTESTINGFRAMEWORK_ASSERT_ERROR_IF_FALSE(property.check("PORTS"),
                         "A list of the ports must be given");
 
     yarp::os::Bottle portsSet = property.findGroup("PORTS").tail();
     for(unsigned int i=0; i<portsSet.size(); i++) {
         yarp::os::Bottle* btport = portsSet.get(i).asList();
-        ROBOTTESTINGFRAMEWORK_ASSERT_ERROR_IF(btport && btport->size()>=3, "The ports must be given as lists of <portname> <toleratedDuplicates>");
+        ROBOTTESTINGFRAMEWORK_ASSERT_ERROR_IF_FALSE(btport && btport->size()>=2, "The ports must be given as lists of <portname> <toleratedDuplicates>");
         DuplicateReadingsPortInfo info;
         info.name = btport->get(0).asString();
         info.toleratedDuplicates = btport->get(1).asInt32();
+        info.stuckTime = stuckTime;
+        info.stuckTolerance = stuckTolerance;
+        info.toleratedStuckChannels = toleratedStuckChannels;
+        for(unsigned int j=2; j<btport->size(); j++) {
+            yarp::os::Bottle* btopt = btport->get(j).asList();
+            ROBOTTESTINGFRAMEWORK_ASSERT_ERROR_IF_FALSE(btopt && btopt->size()>=2,
+                                "The port options must be given as lists of <key> <value>");
+            std::string key = btopt->get(0).asString();
+            if(key == "stuck_time")
+                info.stuckTime = btopt->get(1).asFloat64();
+            else if(key == "stuck_tolerance")
+                info.stuckTolerance = btopt->get(1).asFloat64();
+            else if(key == "tolerated_stuck_channels")
+                info.toleratedStuckChannels = btopt->get(1).asInt32();
+            else
+                ROBOTTESTINGFRAMEWORK_ASSERT_ERROR(Asserter::format("Unknown option %s", key.c_str()));
+        }
         ports.push_back(info);
     }
 
-    // opening port
-    ROBOTTESTINGFRAMEWORK_ASSERT_ERROR_IF(port.open("..."),
-                        "opening port, is YARP network available?");
+    // opening ports
+    for(unsigned int i=0; i<ports.size(); i++) {
+        DuplicateDetector* detector = new DuplicateDetector;
+        detectors.push_back(detector);
+        ROBOTTESTINGFRAMEWORK_ASSERT_ERROR_IF_FALSE(detector->open("..."),
+                            "opening port, is YARP network available?");
+    }
     return true;
 }
 
 void SensorsDuplicateReadings::tearDown() {
     // finalization goes her ...
-    port.close();
+    for(unsigned int i=0; i<detectors.size(); i++) {
+        detectors[i]->close();
+        delete detectors[i];
+    }
+    detectors.clear();
 }
 
 void SensorsDuplicateReadings::run() {
+    std::vector<bool> connected(ports.size(), false);
     for(unsigned int i=0; i<ports.size(); i++) {
-        port.reset();
-        ROBOTTESTINGFRAMEWORK_TEST_REPORT(Asserter::format("Checking port %s ...", ports[i].name.c_str()));
-        bool connected = Network::connect(ports[i].name.c_str(), port.getName());
-        ROBOTTESTINGFRAMEWORK_TEST_FAIL_IF(connected,
+        detectors[i]->reset();
+        detectors[i]->getChannels().configure(ports[i].stuckTime, ports[i].stuckTolerance);
+        connected[i] = Network::connect(ports[i].name.c_str(), detectors[i]->getName());
+        ROBOTTESTINGFRAMEWORK_TEST_FAIL_IF_FALSE(connected[i],
                        Asserter::format("could not connect to remote port %s.", ports[i].name.c_str()));
-        if(connected) {
-            port.useCallback();
-            Time::delay(testTime);
-            port.disableCallback();
-
-            ROBOTTESTINGFRAMEWORK_TEST_REPORT(Asserter::format("Computed a total of %lu duplicates out of %lu samples.",
-                            port.getTotalNrOfDuplicates(),port.getCount()));
-            ROBOTTESTINGFRAMEWORK_TEST_REPORT(Asserter::format("Maximum number of consecutive duplicates: %lu Maximum jitter: %lf ",
-                                              port.getMaxNrOfDuplicates(), port.getMaxJitter()));
-
-            ROBOTTESTINGFRAMEWORK_TEST_FAIL_IF(port.getTotalNrOfDuplicates() > ports[i].toleratedDuplicates,
-                           Asserter::format("Number of duplicates (%lu) is higher than the tolerated (%d)",
-                                            port.getTotalNrOfDuplicates(),
-                                            ports[i].toleratedDuplicates));
-
-            Network::disconnect(ports[i].name.c_str(), port.getName());
-        }
+    }
+
+    // all the ports are checked at the same time
+    for(unsigned int i=0; i<ports.size(); i++)
+        if(connected[i])
+            detectors[i]->useCallback();
+    Time::delay(testTime);
+    for(unsigned int i=0; i<ports.size(); i++)
+        if(connected[i])
+            detectors[i]->disableCallback();
+
+    for(unsigned int i=0; i<ports.size(); i++) {
+        if(!connected[i])
+            continue;
+        DuplicateDetector& port = *detectors[i];
+        ROBOTTESTINGFRAMEWORK_TEST_REPORT(Asserter::format("Checking port %s ...", ports[i].name.c_str()));
+        ROBOTTESTINGFRAMEWORK_TEST_REPORT(Asserter::format("Computed a total of %lu duplicates out of %lu samples.",
+                        port.getTotalNrOfDuplicates(),port.getCount()));
+        ROBOTTESTINGFRAMEWORK_TEST_REPORT(Asserter::format("Maximum number of consecutive duplicates: %lu Maximum jitter: %lf ",
+                                          port.getMaxNrOfDuplicates(), port.getMaxJitter()));
+
+        ROBOTTESTINGFRAMEWORK_TEST_FAIL_IF_FALSE(port.getTotalNrOfDuplicates() <= (unsigned long)ports[i].toleratedDuplicates,
+                       Asserter::format("Number of duplicates (%lu) is higher than the tolerated (%d)",
+                                        port.getTotalNrOfDuplicates(),
+                                        ports[i].toleratedDuplicates));
+
+        if(ports[i].stuckTime > 0)
+            checkChannels(ports[i], port.getChannels());
+
+        Network::disconnect(ports[i].name.c_str(), port.getName());
     }
 }
 
+void SensorsDuplicateReadings::checkChannels(const DuplicateReadingsPortInfo& info,
+                                             const StuckChannelTracker& channels) {
+    int stuck = 0;
+    size_t worst = 0;
+    for(size_t c=0; c<channels.size(); c++) {
+        if(channels.getMaxDuration(c) > channels.getMaxDuration(worst))
+            worst = c;
+        if(channels.getStuckEvents(c) == 0)
+            continue;
+        stuck++;
+        // do not flood the report with thousands of taxels
+        if(stuck <= 10)
+            ROBOTTESTINGFRAMEWORK_TEST_REPORT(Asserter::format("Channel %lu stuck %u times, for %.3f s in total (longest: %.3f s)",
+                                             (unsigned long)c, channels.getStuckEvents(c),
+                                             channels.getStuckTime(c), channels.getMaxDuration(c)));
+    }
+    if(channels.size() > 0)
+        ROBOTTESTINGFRAMEWORK_TEST_REPORT(Asserter::format("%d channels out of %lu stuck for longer than %.3f s (longest: channel %lu, %.3f s)",
+                                         stuck, (unsigned long)channels.size(), info.stuckTime,
+                                         (unsigned long)worst, channels.getMaxDuration(worst)));
+    ROBOTTESTINGFRAMEWORK_TEST_FAIL_IF_FALSE(stuck <= info.toleratedStuckChannels,
+                   Asserter::format("Number of stuck channels (%d) is higher than the tolerated (%d)",
+                                    stuck, info.toleratedStuckChannels));
+}
+
+void StuckChannelTracker::resize(size_t channels, const double* values, double t) {
+    last.assign(values, values+channels);
+    runStart.assign(channels, t);
+    maxDuration.assign(channels, 0.0);
+    stuckTime.assign(channels, 0.0);
+    stuckEvents.assign(channels, 0);
+    tprev = t;
+}
+
+void StuckChannelTracker::update(const double* values, size_t channels, double t) {
+    double* pLast = last.data();
+    double* pStart = runStart.data();
+    double* pMax = maxDuration.data();
+    double* pStuck = stuckTime.data();
+    unsigned int* pEvents = stuckEvents.data();
+    double dt = t - tprev;
+    // selects instead of branches, so that the loop can be vectorized
+    for(size_t c=0; c<channels; c++) {
+        double v = values[c];
+        bool same = fabs(v - pLast[c]) <= tolerance;
+        double prevDuration = t - dt - pStart[c];
+        pLast[c] = same ? pLast[c] : v;
+        pStart[c] = same ? pStart[c] : t;
+        double duration = t - pStart[c];
+        pMax[c] = (duration > pMax[c]) ? duration : pMax[c];
+        pStuck[c] += (duration > threshold) ? dt : 0.0;
+        pEvents[c] += (duration > threshold && prevDuration <= threshold) ? 1 : 0;
+    }
+    tprev = t;
+}
+
 void DuplicateDetector::onRead(yarp::sig::Vector& vec) {
     double tcurrent = Time::now();
+    size_t n = vec.size();
 
-    if(count == 0)
+    if(count == 0 || n != lastReading.size())
     {
-        lastReading = vec;
-        currentJitter = 0.0;
-        currentNrOfDuplicates = 0;
-        totalNrOfDuplicates = 0;
-        lastNewValueTime = tcurrent;
-        maxJitter = currentJitter;
-        maxNrOfDuplicates = currentNrOfDuplicates;
+        // the only place where memory is allocated
+        lastReading.resize(n);
+        memcpy(lastReading.data(), vec.data(), n*sizeof(double));
+        if(channels.isEnabled())
+            channels.resize(n, vec.data(), tcurrent);
+        if(count == 0)
+        {
+            currentJitter = 0.0;
+            currentNrOfDuplicates = 0;
+            totalNrOfDuplicates = 0;
+            lastNewValueTime = tcurrent;
+            maxJitter = currentJitter;
+            maxNrOfDuplicates = currentNrOfDuplicates;
+        }
     }
     else
     {
+        if(channels.isEnabled())
+            channels.update(vec.data(), n, tcurrent);
+
         // Check for duplicate data
-        double diff = yarp::math::norm(vec-lastReading);
-        if( diff < this->tolerance )
+        if( isCloserThan(vec.data(), lastReading.data(), n, tolerance*tolerance) )
         {
             // duplicate ! report a duplicate
             currentNrOfDuplicates++;
@@ -124,13 +272,13 @@ void DuplicateDetector::onRead(yarp::sig::Vector& vec) {
             totalNrOfDuplicates++;
 
             maxJitter = std::max(currentJitter,maxJitter);
-            maxNrOfDuplicates = std::max(currentJitter,maxJitter);
+            maxNrOfDuplicates = std::max(currentNrOfDuplicates,maxNrOfDuplicates);
 
         }
         else
         {
             // not duplicate! update last read value
-            lastReading = vec;
+            memcpy(lastReading.data(), vec.data(), n*sizeof(double));
             currentNrOfDuplicates = 0;
             currentJitter = 0.0;
             lastNewValueTime = tcurrent;
@@ -30,6 +30,52 @@ class DuplicateReadingsPortInfo {
 public:
     std::string name;
     int toleratedDuplicates;
+    double stuckTime;               // <= 0 to disable the per-channel check
+    double stuckTolerance;
+    int toleratedStuckChannels;
+};
+
+
+/**
+ * Tracks, for every channel of a vector stream, for how long its value has
+ * not changed (within a tolerance). The state is kept as a structure of arrays,
+ * allocated once, and updated with branch-free loops over the channels, so that
+ * vectors of thousands of channels can be followed at the rate of the wrapper.
+ */
+class StuckChannelTracker {
+public:
+    StuckChannelTracker() : tolerance(1e-12), threshold(1.0), tprev(0.0) { }
+
+    void configure(double stuckTime, double stuckTolerance) {
+        threshold = stuckTime;
+        tolerance = stuckTolerance;
+    }
+
+    /** False if configured with a stuck time <= 0: the channels are not tracked. */
+    bool isEnabled() const { return threshold > 0.0; }
+
+    /** Sets the number of channels and clears the statistics (allocates). */
+    void resize(size_t channels, const double* values, double t);
+
+    void update(const double* values, size_t channels, double t);
+
+    size_t size() const { return last.size(); }
+    /** The longest time the channel has kept the same value. */
+    double getMaxDuration(size_t channel) const { return maxDuration[channel]; }
+    /** The total time the channel has been stuck for longer than the threshold. */
+    double getStuckTime(size_t channel) const { return stuckTime[channel]; }
+    /** How many times the channel got stuck for longer than the threshold. */
+    unsigned int getStuckEvents(size_t channel) const { return stuckEvents[channel]; }
+
+private:
+    double tolerance;
+    double threshold;
+    double tprev;
+    std::vector<double> last;           // last distinct value
+    std::vector<double> runStart;       // when the last distinct value was received
+    std::vector<double> maxDuration;
+    std::vector<double> stuckTime;
+    std::vector<unsigned int> stuckEvents;
 };
 
 
@@ -41,6 +87,8 @@ public:
         tolerance = 1e-12;
     }
 
+    StuckChannelTracker& getChannels() { return channels; }
+
     unsigned long getCount() { return count; }
     unsigned long getMaxNrOfDuplicates() { return maxNrOfDuplicates; }
     double getMaxJitter() { return maxJitter; }
@@ -57,7 +105,8 @@ private:
     double        lastNewValueTime;
     double        currentJitter;
     double        maxJitter;
-    yarp::sig::Vector lastReading;
+    std::vector<double> lastReading;    // allocated once, then overwritten in place
+    StuckChannelTracker channels;
 };
 
 
@@ -80,9 +129,21 @@ private:
  * | Parameter name | Type   | Units | Default Value | Required | Description | Notes |
  * |:--------------:|:------:|:-----:|:-------------:|:--------:|:-----------:|:-----:|
  * | name           | string | -     | "SensorsDuplicateReadings" | No       | The name of the test. | -     |
- * | time           | double | s     | -             | Yes      | Duration of the test for each port. | - |
- * | PORTS (group ) | Bottle | -     | -             | Yes      | List of couples of port/toleratedDuplicates with this format: (portname1, toleratedDuplicates1) (portname1, toleratedDuplicates1) | |
+ * | time           | double | s     | 2             | No       | Duration of the test. | All the ports are checked at the same time. |
+ * | stuck_time     | double | s     | 0             | No       | A channel whose value does not change for longer than this is stuck. | 0 disables the per-channel check. |
+ * | stuck_tolerance | double | -    | 1e-12         | No       | The changes of a channel smaller than this are ignored. | - |
+ * | tolerated_stuck_channels | int | - | 0          | No       | The number of channels of each port which may get stuck. | - |
+ * | PORTS (group ) | Bottle | -     | -             | Yes      | List of couples of port/toleratedDuplicates with this format: (portname1, toleratedDuplicates1) (portname1, toleratedDuplicates1) | The three parameters above can be overridden for a port by appending e.g. `(stuck_time 0.5)` |
+ *
+ * Besides whole repeated vectors, the test can look for single stuck channels
+ * (e.g. a dead strain gauge or skin taxel inside an otherwise live vector):
+ * for every channel the longest time without changes, the number of times it got
+ * stuck for longer than `stuck_time` and the total stuck time are computed.
  *
+ * Each port is read by its own detector and all of them are checked concurrently.
+ * The readings are compared in place with the previous one (no temporary
+ * vectors are allocated), so that high-rate ports with many channels can be
+ * monitored at full rate.
  *
  */
 class SensorsDuplicateReadings : public yarp::robottestingframework::TestCase {
@@ -97,9 +158,13 @@ public:
     virtual void run();
 
 private:
-    DuplicateDetector port;
+    void checkChannels(const DuplicateReadingsPortInfo& info,
+                       const StuckChannelTracker& channels);
+
+private:
+    std::vector<DuplicateDetector*> detectors;  // one detector per port
     std::vector<DuplicateReadingsPortInfo> ports;
     double testTime;
 };
 
-#endif //_PORTSFREQUENCY_H
+#endif //_SENSORSDUPLICATEREADINGS_H_
@@ -0,0 +1,189 @@
+/*
+ * iCub Robot Unit Tests (Robot Testing Framework)
+ *
+ * Copyright (C) 2015-2019 Istituto Italiano di Tecnologia (IIT)
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+#include <cstdio>
+#include <robottestingframework/dll/Plugin.h>
+#include <yarp/os/Network.h>
+#include <yarp/os/Time.h>
+#include "StreamGenerator.h"
+
+using namespace std;
+using namespace robottestingframework;
+using namespace yarp::os;
+using namespace yarp::sig;
+
+ROBOTTESTINGFRAMEWORK_PREPARE_FIXTURE_PLUGIN(StreamGenerator)
+
+StreamPublisher::StreamPublisher() :
+    size(16), width(320), height(240),
+    rate(100), jitter(0.0), gaussian(false),
+    dropProbability(0.0), duplicateProbability(0.0),
+    uniform(0.0, 1.0), normal(0.0, 1.0),
+    sent(0), dropped(0), duplicated(0) {
+}
+
+bool StreamPublisher::configure(yarp::os::Searchable& config) {
+    if(!config.check("name")) {
+        printf("StreamGenerator: missing 'name' of the stream.\n");
+        return false;
+    }
+    name = config.find("name").asString();
+    rate = config.check("rate") ? config.find("rate").asFloat64() : 100;
+    size = config.check("size") ? config.find("size").asInt32() : 16;
+    width = config.check("width") ? config.find("width").asInt32() : 320;
+    height = config.check("height") ? config.find("height").asInt32() : 240;
+    jitter = config.check("jitter") ? config.find("jitter").asFloat64() : 0.0;
+    gaussian = config.check("jitter_distribution") &&
+               (config.find("jitter_distribution").asString() == "gaussian");
+    dropProbability = config.check("drop") ? config.find("drop").asFloat64() : 0.0;
+    duplicateProbability = config.check("duplicate") ? config.find("duplicate").asFloat64() : 0.0;
+    generator.seed(config.check("seed") ? config.find("seed").asInt32() : 0);
+    if(rate <= 0) {
+        printf("StreamGenerator: invalid rate for %s.\n", name.c_str());
+        return false;
+    }
+    return openPort(name);
+}
+
+double StreamPublisher::nextJitter() {
+    if(jitter <= 0.0)
+        return 0.0;
+    if(gaussian)
+        return jitter*normal(generator);
+    return jitter*(2.0*uniform(generator) - 1.0);
+}
+
+void StreamPublisher::run() {
+    Stamp stamp;
+    unsigned long sample = 0;
+    double period = 1.0/rate;
+    double tstart = Time::now();
+    while(!isStopping()) {
+        // absolute deadline of the next message, plus the injected jitter
+        double deadline = tstart + sample*period + nextJitter();
+        double tnow = Time::now();
+        if(deadline > tnow)
+            Time::delay(deadline - tnow);
+        sample++;
+
+        if(uniform(generator) < dropProbability) {
+            // the stamp counter goes on: the receivers see a gap
+            stamp.update();
+            dropped++;
+            continue;
+        }
+        stamp.update();
+        publish(stamp, sample, false);
+        sent++;
+
+        if(uniform(generator) < duplicateProbability) {
+            publish(stamp, sample, true);
+            duplicated++;
+        }
+    }
+}
+
+template <>
+void TypedStreamPublisher<Bottle>::fill(Bottle& data, unsigned long sample) {
+    data.clear();
+    for(size_t i=0; i<size; i++)
+        data.addFloat64(sample + i*0.001);
+}
+
+template <>
+void TypedStreamPublisher<Vector>::fill(Vector& data, unsigned long sample) {
+    data.resize(size);
+    for(size_t i=0; i<size; i++)
+        data[i] = sample + i*0.001;
+}
+
+template <>
+void TypedStreamPublisher<ImageOf<PixelRgb> >::fill(ImageOf<PixelRgb>& data, unsigned long sample) {
+    data.resize(width, height);
+    unsigned char value = (unsigned char)(sample % 256);
+    for(size_t y=0; y<height; y++) {
+        unsigned char* row = data.getRow(y);
+        for(size_t x=0; x<width*3; x++)
+            row[x] = (unsigned char)(value + x + y);
+    }
+}
+
+
+bool StreamGenerator::setup(int argc, char** argv) {
+    printf("StreamGenerator: setupping fixture...\n");
+    Property prop;
+    prop.fromCommand(argc, argv, false);
+    if(!prop.check("streams")) {
+        printf("StreamGenerator: missing 'streams' param.\n");
+        return false;
+    }
+
+    Bottle streams = prop.findGroup("streams").tail();
+    for(size_t i=0; i<streams.size(); i++) {
+        Bottle* btstream = streams.get(i).asList();
+        if(!btstream) {
+            printf("StreamGenerator: the streams must be given as lists of (key value).\n");
+            tearDown();
+            return false;
+        }
+        Property config(btstream->toString().c_str());
+        std::string type = config.check("type") ? config.find("type").asString() : "vector";
+        StreamPublisher* publisher;
+        if(type == "bottle")
+            publisher = new TypedStreamPublisher<Bottle>;
+        else if(type == "vector")
+            publisher = new TypedStreamPublisher<Vector>;
+        else if(type == "image")
+            publisher = new TypedStreamPublisher<ImageOf<PixelRgb> >;
+        else {
+            printf("StreamGenerator: unknown type %s (use bottle, vector or image).\n", type.c_str());
+            tearDown();
+            return false;
+        }
+        publishers.push_back(publisher);
+        if(!publisher->configure(config) || !publisher->start()) {
+            printf("StreamGenerator: cannot start the stream %s.\n", publisher->getName().c_str());
+            tearDown();
+            return false;
+        }
+        printf("StreamGenerator: publishing %s (%s)\n", publisher->getName().c_str(), type.c_str());
+    }
+    return true;
+}
+
+bool StreamGenerator::check() {
+    for(size_t i=0; i<publishers.size(); i++)
+        if(!publishers[i]->isRunning())
+            return false;
+    return true;
+}
+
+void StreamGenerator::tearDown() {
+    printf("StreamGenerator: tearing down the fixture...\n");
+    for(size_t i=0; i<publishers.size(); i++) {
+        publishers[i]->stop();
+        publishers[i]->closePort();
+        printf("StreamGenerator: %s sent %lu messages (dropped: %lu, duplicated: %lu)\n",
+               publishers[i]->getName().c_str(), publishers[i]->getSent(),
+               publishers[i]->getDropped(), publishers[i]->getDuplicated());
+        delete publishers[i];
+    }
+    publishers.clear();
+}
@@ -0,0 +1,154 @@
+/*
+ * iCub Robot Unit Tests (Robot Testing Framework)
+ *
+ * Copyright (C) 2015-2019 Istituto Italiano di Tecnologia (IIT)
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+#ifndef _STREAMGENERATOR_H_
+#define _STREAMGENERATOR_H_
+
+#include <string>
+#include <vector>
+#include <random>
+#include <robottestingframework/FixtureManager.h>
+#include <yarp/os/Thread.h>
+#include <yarp/os/BufferedPort.h>
+#include <yarp/os/Bottle.h>
+#include <yarp/os/Property.h>
+#include <yarp/os/Stamp.h>
+#include <yarp/sig/Vector.h>
+#include <yarp/sig/Image.h>
+
+
+/**
+ * Publishes one synthetic stamped stream from its own thread.
+ * The messages are sent at absolute deadlines, so the rate does not drift;
+ * jitter, dropped and duplicated messages can be injected on purpose.
+ */
+class StreamPublisher : public yarp::os::Thread {
+public:
+    StreamPublisher();
+    virtual ~StreamPublisher() {}
+
+    bool configure(yarp::os::Searchable& config);
+    virtual void run();
+
+    std::string getName() { return name; }
+    unsigned long getSent() { return sent; }
+    unsigned long getDropped() { return dropped; }
+    unsigned long getDuplicated() { return duplicated; }
+
+    virtual bool openPort(const std::string& name) = 0;
+    virtual void closePort() = 0;
+
+protected:
+    // fills the next message (repeat: send again the previous one) and writes it
+    virtual void publish(yarp::os::Stamp& stamp, unsigned long sample, bool repeat) = 0;
+
+protected:
+    std::string name;
+    size_t size;
+    size_t width, height;
+
+private:
+    double nextJitter();
+
+private:
+    double rate;
+    double jitter;
+    bool gaussian;
+    double dropProbability;
+    double duplicateProbability;
+    std::mt19937 generator;
+    std::uniform_real_distribution<double> uniform;
+    std::normal_distribution<double> normal;
+    unsigned long sent, dropped, duplicated;
+};
+
+
+template <class T>
+class TypedStreamPublisher : public StreamPublisher {
+public:
+    virtual bool openPort(const std::string& name) {
+        port.setStrict();
+        return port.open(name);
+    }
+
+    virtual void closePort() {
+        port.interrupt();
+        port.close();
+    }
+
+protected:
+    virtual void publish(yarp::os::Stamp& stamp, unsigned long sample, bool repeat) {
+        T& data = port.prepare();
+        if(repeat)
+            data = last;
+        else {
+            fill(data, sample);
+            last = data;
+        }
+        port.setEnvelope(stamp);
+        port.write(true);
+    }
+
+private:
+    void fill(T& data, unsigned long sample);
+
+private:
+    yarp::os::BufferedPort<T> port;
+    T last;
+};
+
+
+/**
+* \ingroup icub-tests
+* A fixture which publishes synthetic stamped streams (Bottles, Vectors and Images),
+* as a local stand-in for the robot wrappers when testing the stream probes
+* (e.g. PortsFrequency, SensorsDuplicateReadings, CameraTest) on a plain machine.
+*
+* The streams are given as a list of lists with the `--streams` parameter,
+* each one with the following keys:
+* | Parameter name | Type   | Units | Default Value | Required | Description | Notes |
+* |:--------------:|:------:|:-----:|:-------------:|:--------:|:-----------:|:-----:|
+* | name           | string | -     | -             | Yes      | The name of the port. | - |
+* | type           | string | -     | "vector"      | No       | The type of the messages: `bottle`, `vector` or `image`. | - |
+* | rate           | double | Hz    | 100           | No       | The publishing rate. | Up to a few kHz. |
+* | size           | int    | -     | 16            | No       | The number of elements of bottles and vectors. | - |
+* | width, height  | int    | pixels| 320, 240      | No       | The size of the RGB images. | - |
+* | jitter         | double | s     | 0             | No       | The amplitude (uniform) or standard deviation (gaussian) of the jitter added to each deadline. | - |
+* | jitter_distribution | string | - | "uniform"   | No       | `uniform` or `gaussian`. | - |
+* | drop           | double | -     | 0             | No       | The probability of dropping a message. | The stamp counter is incremented anyway, so the gap is visible to the receivers. |
+* | duplicate      | double | -     | 0             | No       | The probability of sending a message again, with the same content and stamp. | - |
+* | seed           | int    | -     | 0             | No       | The seed of the random generator. | - |
+*
+* Example:
+* \verbatim
+* <fixture param="--streams ((name /generator/state:o) (rate 1000) (size 32) (drop 0.001)) ((name /generator/image) (type image) (rate 30))"> StreamGenerator </fixture>
+* \endverbatim
+*/
+class StreamGenerator : public robottestingframework::FixtureManager {
+public:
+    virtual bool setup(int argc, char** argv);
+    virtual bool check();
+    virtual void tearDown();
+
+private:
+    std::vector<StreamPublisher*> publishers;
+};
+
+#endif //_STREAMGENERATOR_H_
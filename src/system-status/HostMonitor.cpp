@@ -0,0 +1,182 @@
+/*
+ * iCub Robot Unit Tests (Robot Testing Framework)
+ *
+ * Copyright (C) 2015-2019 Istituto Italiano di Tecnologia (IIT)
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+#include <cstdio>
+#include <algorithm>
+#include <yarp/os/Network.h>
+#include <yarp/os/Time.h>
+#include <yarp/os/Bottle.h>
+#include <yarp/os/ContactStyle.h>
+#include <yarp/os/SystemInfoSerializer.h>
+#include "HostMonitor.h"
+
+using namespace yarp::os;
+
+
+HostMonitor::HostMonitor(const std::string& host, double period, size_t history, double timeout) :
+    host(host), period(period), timeout(timeout), connected(false),
+    samples(history), count(0), failures(0) {
+    peakCpu.time = peakLoad.time = lowestFree.time = 0.0;
+    peakCpu.cpu = -1;
+    peakLoad.load1 = -1.0;
+    lowestFree.freeMemory = -1;
+}
+
+HostMonitor::~HostMonitor() {
+    if(isRunning())
+        stop();
+}
+
+bool HostMonitor::sample(HostSample& sample) {
+    if(!connected) {
+        ContactStyle style;
+        style.quiet = true;
+        style.timeout = timeout;
+        connected = Network::connect(port.getName(), host, style);
+        if(!connected)
+            return false;
+    }
+
+    Bottle msg, grp;
+    grp.addString("sysinfo");
+    msg.addList() = grp;
+    SystemInfoSerializer info;
+    if(!port.write(msg, info)) {
+        // opened again at the next sample
+        Network::disconnect(port.getName(), host);
+        connected = false;
+        return false;
+    }
+    sample.time = Time::now();
+    sample.cpu = info.load.cpuLoadInstant;
+    sample.load1 = info.load.cpuLoad1;
+    sample.load5 = info.load.cpuLoad5;
+    sample.load15 = info.load.cpuLoad15;
+    sample.totalMemory = info.memory.totalSpace;
+    sample.freeMemory = info.memory.freeSpace;
+    return true;
+}
+
+bool HostMonitor::threadInit() {
+    port.setTimeout(timeout);
+    return port.open("...");
+}
+
+void HostMonitor::run() {
+    double deadline = Time::now();
+    while(!isStopping()) {
+        HostSample current;
+        bool ok = sample(current);
+        {
+            std::lock_guard<std::mutex> guard(mutex);
+            if(ok) {
+                samples.push(current);
+                if(current.cpu > peakCpu.cpu)
+                    peakCpu = current;
+                if(current.load1 > peakLoad.load1)
+                    peakLoad = current;
+                if(lowestFree.freeMemory < 0 || current.freeMemory < lowestFree.freeMemory)
+                    lowestFree = current;
+            }
+            else
+                failures++;
+            count++;
+        }
+
+        // absolute deadlines, skipping the ones missed by a slow reply
+        deadline += period;
+        double now = Time::now();
+        if(deadline < now)
+            deadline = now;
+        while(!isStopping() && Time::now() < deadline)
+            Time::delay(std::min(0.1, deadline - Time::now()));
+    }
+}
+
+void HostMonitor::threadRelease() {
+    if(connected)
+        Network::disconnect(port.getName(), host);
+    connected = false;
+    port.close();
+}
+
+void HostMonitor::waitSamples(unsigned long n) {
+    while(isRunning() && getCount() < n)
+        Time::delay(0.01);
+}
+
+unsigned long HostMonitor::getCount() {
+    std::lock_guard<std::mutex> guard(mutex);
+    return count;
+}
+
+unsigned long HostMonitor::getFailures() {
+    std::lock_guard<std::mutex> guard(mutex);
+    return failures;
+}
+
+std::vector<HostSample> HostMonitor::getSamples() {
+    std::lock_guard<std::mutex> guard(mutex);
+    std::vector<HostSample> series;
+    series.reserve(samples.size());
+    for(size_t i=0; i<samples.size(); i++)
+        series.push_back(samples[i]);
+    return series;
+}
+
+bool HostMonitor::getLast(HostSample& sample) {
+    std::lock_guard<std::mutex> guard(mutex);
+    if(samples.empty())
+        return false;
+    sample = samples.back();
+    return true;
+}
+
+HostSample HostMonitor::getPeakCpu() {
+    std::lock_guard<std::mutex> guard(mutex);
+    return peakCpu;
+}
+
+HostSample HostMonitor::getPeakLoad() {
+    std::lock_guard<std::mutex> guard(mutex);
+    return peakLoad;
+}
+
+HostSample HostMonitor::getLowestFreeMemory() {
+    std::lock_guard<std::mutex> guard(mutex);
+    return lowestFree;
+}
+
+bool HostMonitor::writeSeries(const std::vector<HostMonitor*>& monitors, const std::string& filename) {
+    FILE* file = fopen(filename.c_str(), "w");
+    if(!file)
+        return false;
+    fprintf(file, "time,host,cpu,load1,load5,load15,free_memory,total_memory\n");
+    for(size_t i=0; i<monitors.size(); i++) {
+        std::vector<HostSample> series = monitors[i]->getSamples();
+        for(size_t j=0; j<series.size(); j++)
+            fprintf(file, "%.3f,%s,%d,%.2f,%.2f,%.2f,%d,%d\n",
+                    series[j].time, monitors[i]->getHost().c_str(), series[j].cpu,
+                    series[j].load1, series[j].load5, series[j].load15,
+                    series[j].freeMemory, series[j].totalMemory);
+    }
+    fclose(file);
+    return true;
+}
@@ -0,0 +1,97 @@
+/*
+ * iCub Robot Unit Tests (Robot Testing Framework)
+ *
+ * Copyright (C) 2015-2019 Istituto Italiano di Tecnologia (IIT)
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+
+#ifndef _HOST_MONITOR_H_
+#define _HOST_MONITOR_H_
+
+#include <string>
+#include <vector>
+#include <mutex>
+#include <yarp/os/Thread.h>
+#include <yarp/os/Port.h>
+#include "RingBuffer.h"
+
+class HostSample {
+public:
+    double time;                // local time of the reply
+    int cpu;                    // instant cpu load (%)
+    double load1, load5, load15;
+    int totalMemory;            // MB
+    int freeMemory;             // MB
+};
+
+
+/**
+ * Samples the status of a host periodically, asking the yarprun running on
+ * it (sysinfo command) over a connection kept open for the whole monitoring.
+ * Each host has its own thread, so a slow or unreachable host does not delay
+ * the others; a request which does not complete within the timeout is counted
+ * as a failure and the connection is opened again at the next sample.
+ *
+ * The last samples are kept in a ring buffer, while the peaks are computed
+ * over all of them.
+ */
+class HostMonitor : public yarp::os::Thread {
+public:
+    HostMonitor(const std::string& host, double period=1.0, size_t history=3600, double timeout=5.0);
+    virtual ~HostMonitor();
+
+    virtual bool threadInit();
+    virtual void run();
+    virtual void threadRelease();
+
+    std::string getHost() { return host; }
+
+    /** Blocks until at least the given number of samples (or failures) are collected. */
+    void waitSamples(unsigned long count);
+
+    // all the getters lock the monitor, so they can be called while it runs
+    unsigned long getCount();
+    unsigned long getFailures();
+    std::vector<HostSample> getSamples();
+    bool getLast(HostSample& sample);
+    HostSample getPeakCpu();
+    HostSample getPeakLoad();
+    HostSample getLowestFreeMemory();
+
+    /**
+     * Writes the samples of all the monitors in a CSV file, one row per sample:
+     * time, host, cpu, load1, load5, load15, free_memory, total_memory
+     */
+    static bool writeSeries(const std::vector<HostMonitor*>& monitors, const std::string& filename);
+
+private:
+    bool sample(HostSample& sample);
+
+private:
+    std::string host;
+    double period;
+    double timeout;
+    yarp::os::Port port;
+    bool connected;
+    std::mutex mutex;
+    RingBuffer<HostSample> samples;
+    unsigned long count;
+    unsigned long failures;
+    HostSample peakCpu, peakLoad, lowestFree;
+};
+
+#endif //_HOST_MONITOR_H_
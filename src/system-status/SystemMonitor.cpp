@@ -0,0 +1,92 @@
+/*
+ * iCub Robot Unit Tests (Robot Testing Framework)
+ *
+ * Copyright (C) 2015-2019 Istituto Italiano di Tecnologia (IIT)
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+
+#include <cstdio>
+#include <robottestingframework/dll/Plugin.h>
+#include <yarp/os/Property.h>
+#include <yarp/os/Bottle.h>
+#include <yarp/os/Time.h>
+#include "SystemMonitor.h"
+
+using namespace robottestingframework;
+using namespace yarp::os;
+
+#define CONNECTION_TIMEOUT      5.0         //seconds
+
+ROBOTTESTINGFRAMEWORK_PREPARE_FIXTURE_PLUGIN(SystemMonitor)
+
+bool SystemMonitor::setup(int argc, char** argv) {
+    printf("SystemMonitor: setupping fixture...\n");
+    Property prop;
+    prop.fromCommand(argc, argv, false);
+    Bottle* bthosts = prop.find("hosts").asList();
+    if(!bthosts || bthosts->size() == 0) {
+        printf("SystemMonitor: missing 'hosts' param.\n");
+        return false;
+    }
+    double period = prop.check("period") ? prop.find("period").asFloat64() : 1.0;
+    int history = prop.check("history") ? prop.find("history").asInt32() : 36000;
+    output = prop.check("output") ? prop.find("output").asString() : "";
+
+    for(size_t i=0; i<bthosts->size(); i++) {
+        HostMonitor* monitor = new HostMonitor(bthosts->get(i).asString(), period, history, CONNECTION_TIMEOUT);
+        monitors.push_back(monitor);
+        if(!monitor->start()) {
+            printf("SystemMonitor: cannot start the monitor of %s.\n", monitor->getHost().c_str());
+            tearDown();
+            return false;
+        }
+        printf("SystemMonitor: monitoring %s every %.2f s\n", monitor->getHost().c_str(), period);
+    }
+    return true;
+}
+
+bool SystemMonitor::check() {
+    for(size_t i=0; i<monitors.size(); i++)
+        if(!monitors[i]->isRunning())
+            return false;
+    return true;
+}
+
+void SystemMonitor::tearDown() {
+    printf("SystemMonitor: tearing down the fixture...\n");
+    for(size_t i=0; i<monitors.size(); i++)
+        monitors[i]->stop();
+    for(size_t i=0; i<monitors.size(); i++) {
+        HostMonitor* monitor = monitors[i];
+        HostSample peakCpu = monitor->getPeakCpu();
+        HostSample peakLoad = monitor->getPeakLoad();
+        HostSample lowestFree = monitor->getLowestFreeMemory();
+        printf("SystemMonitor: %s: %lu samples (%lu failed), cpu peak %d%% at %.3f, load average peak %.2f at %.3f, lowest free memory %d MB at %.3f\n",
+               monitor->getHost().c_str(), monitor->getCount(), monitor->getFailures(),
+               peakCpu.cpu, peakCpu.time, peakLoad.load1, peakLoad.time,
+               lowestFree.freeMemory, lowestFree.time);
+    }
+    if(!output.empty()) {
+        if(HostMonitor::writeSeries(monitors, output))
+            printf("SystemMonitor: samples written to %s\n", output.c_str());
+        else
+            printf("SystemMonitor: cannot write %s\n", output.c_str());
+    }
+    for(size_t i=0; i<monitors.size(); i++)
+        delete monitors[i];
+    monitors.clear();
+}
@@ -0,0 +1,60 @@
+/*
+ * iCub Robot Unit Tests (Robot Testing Framework)
+ *
+ * Copyright (C) 2015-2019 Istituto Italiano di Tecnologia (IIT)
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+
+#ifndef _SYSTEM_MONITOR_H_
+#define _SYSTEM_MONITOR_H_
+
+#include <string>
+#include <vector>
+#include <robottestingframework/FixtureManager.h>
+#include "HostMonitor.h"
+
+
+/**
+* \ingroup icub-tests
+* A fixture which samples the load and the memory of a set of hosts (see HostMonitor)
+* for the whole duration of a suite, so that frequency drops or timeouts in the tests
+* can be correlated with the load of the hosts.
+*
+* | Parameter name | Type   | Units | Default Value | Required | Description | Notes |
+* |:--------------:|:------:|:-----:|:-------------:|:--------:|:-----------:|:-----:|
+* | hosts          | list   | -     | -             | Yes      | The names of the yarprun running on the hosts. | - |
+* | period         | double | s     | 1             | No       | The sampling period. | - |
+* | history        | int    | -     | 36000         | No       | The number of samples kept for each host. | - |
+* | output         | string | -     | -             | No       | If given, the samples are written to this CSV file when the suite ends. | Time stamps are absolute. |
+*
+* Example:
+* \verbatim
+* <fixture param="--hosts (/icub-head /pc104) --period 0.5 --output system_status.csv"> SystemMonitor </fixture>
+* \endverbatim
+*/
+class SystemMonitor : public robottestingframework::FixtureManager {
+public:
+    virtual bool setup(int argc, char** argv);
+    virtual bool check();
+    virtual void tearDown();
+
+private:
+    std::vector<HostMonitor*> monitors;
+    std::string output;
+};
+
+#endif //_SYSTEM_MONITOR_H_
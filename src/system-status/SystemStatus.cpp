@@ -18,9 +18,11 @@
  * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
  */
 
+#include <algorithm>
 #include <robottestingframework/dll/Plugin.h>
-#include <yarp/os/Port.h>
-#include <yarp/os/SystemInfoSerializer.h>
+#include <robottestingframework/TestAssert.h>
+#include <yarp/os/Bottle.h>
+#include <yarp/os/Time.h>
 #include "SystemStatus.h"
 
 using namespace std;
@@ -28,6 +30,7 @@ using namespace robottestingframework;
 using namespace yarp::os;
 
 #define CONNECTION_TIMEOUT      5.0         //seconds
+#define MAX_SERIES_LENGTH       60          //values reported per series
 
 // prepare the plugin
 ROBOTTESTINGFRAMEWORK_PREPARE_PLUGIN(SystemStatus)
@@ -44,15 +47,21 @@ bool SystemStatus::setup(yarp::os::Property &property) {
     if(property.check("name"))
         setName(property.find("name").asString());
 
-    ROBOTTESTINGFRAMEWORK_ASSERT_ERROR_IF(property.check("hosts"),
+    ROBOTTESTINGFRAMEWORK_ASSERT_ERROR_IF_FALSE(property.check("hosts"),
                         "A list of hosts name must be given using 'hosts' param");
+    time = property.check("time") ? property.find("time").asFloat64() : 0.0;
+    period = property.check("period") ? property.find("period").asFloat64() : 1.0;
+    output = property.check("output") ? property.find("output").asString() : "";
+    ROBOTTESTINGFRAMEWORK_ASSERT_ERROR_IF_FALSE(period > 0, "The period must be positive");
+
     yarp::os::Bottle portsSet = property.findGroup("hosts").tail();
     for(unsigned int i=0; i<portsSet.size(); i++) {
         yarp::os::Bottle* btport = portsSet.get(i).asList();
-        ROBOTTESTINGFRAMEWORK_ASSERT_ERROR_IF(btport && btport->size()>=2, "Hosts must be given as lists of <host name> <max cpu load>");
+        ROBOTTESTINGFRAMEWORK_ASSERT_ERROR_IF_FALSE(btport && btport->size()>=2, "Hosts must be given as lists of <host name> <max cpu load>");
         HostInfo info;
         info.name = btport->get(0).asString();
         info.maxCpuLoad = btport->get(1).asInt32();
+        info.minFreeMemory = (btport->size() >= 3) ? btport->get(2).asInt32() : -1;
         hosts.push_back(info);
     }
 
@@ -60,65 +69,77 @@ bool SystemStatus::setup(yarp::os::Property &property) {
 }
 
 void SystemStatus::tearDown() {
-    // finalization goes her ...
+    for(size_t i=0; i<monitors.size(); i++) {
+        monitors[i]->stop();
+        delete monitors[i];
+    }
+    monitors.clear();
 }
 
 void SystemStatus::run() {
+    // one thread per host: they are all sampled at the same time
+    size_t history = (size_t)(time/period) + 2;
     for(unsigned int i=0; i<hosts.size(); i++) {
-        SystemInfoSerializer info;
-        ROBOTTESTINGFRAMEWORK_TEST_REPORT("");
-        ROBOTTESTINGFRAMEWORK_TEST_REPORT(Asserter::format("Checking host %s ...", hosts[i].name.c_str()));
-        bool ret = getSystemInfo(hosts[i].name, info);
-        ROBOTTESTINGFRAMEWORK_TEST_FAIL_IF(ret, Asserter::format("Failed to get the system status of host %s. Is the yarprun running on %s?",
-                                             hosts[i].name.c_str(), hosts[i].name.c_str()));
-        if(ret) {
-            ROBOTTESTINGFRAMEWORK_TEST_REPORT(Asserter::format("Total memory %d MB, free memory %d MB.",
-                                             info.memory.totalSpace, info.memory.freeSpace));
-            unsigned int cpuLoad1 = (int)(info.load.cpuLoad1*100);
-            unsigned int cpuLoad5 = (int)(info.load.cpuLoad5*100);
-            unsigned int cpuLoad15 = (int)(info.load.cpuLoad15*100);
-            ROBOTTESTINGFRAMEWORK_TEST_REPORT(Asserter::format("Cpu load during last minute %d\%, last 5 minutes %d\%, last 15 minutes %d\%",
-                                             cpuLoad1, cpuLoad5, cpuLoad15));
-            ROBOTTESTINGFRAMEWORK_TEST_FAIL_IF(cpuLoad1 < hosts[i].maxCpuLoad,
-                           Asserter::format("Cpu load (last minute) is higher than desired [%d\%]", hosts[i].maxCpuLoad));
-        }
+        HostMonitor* monitor = new HostMonitor(hosts[i].name, period, history, CONNECTION_TIMEOUT);
+        monitors.push_back(monitor);
+        ROBOTTESTINGFRAMEWORK_TEST_FAIL_IF_FALSE(monitor->start(),
+                         Asserter::format("Cannot start the monitor of host %s", hosts[i].name.c_str()));
     }
-}
-
-bool SystemStatus::getSystemInfo(std::string remote,
-                                 SystemInfoSerializer& info) {
-
-    yarp::os::Port port;
-
-    // opening the port
-    port.setTimeout(CONNECTION_TIMEOUT);
-    ROBOTTESTINGFRAMEWORK_ASSERT_ERROR_IF(port.open("..."), "Cannot open the yarp port");
-
-    yarp::os::Bottle msg, grp;
-    grp.clear();
-    grp.addString("sysinfo");
-    msg.addList() = grp;
 
-    ContactStyle style;
-    style.quiet = true;
-    style.timeout = CONNECTION_TIMEOUT;
-
-    bool connected = yarp::os::NetworkBase::connect(port.getName(), remote.c_str(), style);
-    if(!connected) {
-        ROBOTTESTINGFRAMEWORK_TEST_FAIL_IF(connected, string("Cannot connect to ") + remote);
-        port.close();
-        return false;
+    double start = yarp::os::Time::now();
+    if(time > 0) {
+        ROBOTTESTINGFRAMEWORK_TEST_REPORT(Asserter::format("Monitoring %d hosts for %.1f seconds...", (int)hosts.size(), time));
+        yarp::os::Time::delay(time);
+    }
+    for(size_t i=0; i<monitors.size(); i++) {
+        monitors[i]->waitSamples(1);
+        monitors[i]->stop();
     }
 
-    bool ret = port.write(msg, info);
-    NetworkBase::disconnect(port.getName().c_str(), remote.c_str());
-    if(!ret) {
-        port.close();
-        ROBOTTESTINGFRAMEWORK_TEST_FAIL_IF(ret, remote + string(" does not respond"));
-        return false;
+    for(unsigned int i=0; i<hosts.size(); i++) {
+        HostMonitor* monitor = monitors[i];
+        ROBOTTESTINGFRAMEWORK_TEST_REPORT("");
+        ROBOTTESTINGFRAMEWORK_TEST_REPORT(Asserter::format("Host %s: %lu samples, %lu failed",
+                                           hosts[i].name.c_str(), monitor->getCount(), monitor->getFailures()));
+        HostSample last;
+        bool ret = monitor->getLast(last);
+        ROBOTTESTINGFRAMEWORK_TEST_FAIL_IF_FALSE(ret, Asserter::format("Failed to get the system status of host %s. Is the yarprun running on %s?",
+                                             hosts[i].name.c_str(), hosts[i].name.c_str()));
+        if(!ret)
+            continue;
+
+        HostSample peakCpu = monitor->getPeakCpu();
+        HostSample peakLoad = monitor->getPeakLoad();
+        HostSample lowestFree = monitor->getLowestFreeMemory();
+        ROBOTTESTINGFRAMEWORK_TEST_REPORT(Asserter::format("Total memory %d MB, free memory %d MB (lowest %d MB at %+.1f s).",
+                                         last.totalMemory, last.freeMemory, lowestFree.freeMemory, lowestFree.time - start));
+        ROBOTTESTINGFRAMEWORK_TEST_REPORT(Asserter::format("Cpu load peak %d%% at %+.1f s, load average peak %.2f at %+.1f s (last: 1 min %.2f, 5 min %.2f, 15 min %.2f)",
+                                         peakCpu.cpu, peakCpu.time - start, peakLoad.load1, peakLoad.time - start,
+                                         last.load1, last.load5, last.load15));
+
+        // the series of the cpu load, with the maximum over groups of samples if too long
+        std::vector<HostSample> series = monitor->getSamples();
+        if(series.size() > 1) {
+            size_t group = (series.size() + MAX_SERIES_LENGTH - 1)/MAX_SERIES_LENGTH;
+            std::string values;
+            for(size_t j=0; j<series.size(); j+=group) {
+                int peak = 0;
+                for(size_t k=j; k<std::min(j+group, series.size()); k++)
+                    peak = std::max(peak, series[k].cpu);
+                values += Asserter::format(" %d", peak);
+            }
+            ROBOTTESTINGFRAMEWORK_TEST_REPORT(Asserter::format("Cpu load (%%) every %.1f s:%s", group*period, values.c_str()));
+        }
+
+        int cpuLoad1 = (int)(peakLoad.load1*100);
+        ROBOTTESTINGFRAMEWORK_TEST_FAIL_IF_FALSE(cpuLoad1 <= hosts[i].maxCpuLoad,
+                       Asserter::format("Cpu load (last minute) %d%% is higher than desired [%d%%]", cpuLoad1, hosts[i].maxCpuLoad));
+        if(hosts[i].minFreeMemory >= 0)
+            ROBOTTESTINGFRAMEWORK_TEST_FAIL_IF_FALSE(lowestFree.freeMemory >= hosts[i].minFreeMemory,
+                           Asserter::format("Free memory %d MB is lower than desired [%d MB]", lowestFree.freeMemory, hosts[i].minFreeMemory));
     }
 
-    port.close();
-    return true;
+    if(!output.empty())
+        ROBOTTESTINGFRAMEWORK_TEST_CHECK(HostMonitor::writeSeries(monitors, output),
+                         Asserter::format("Writing the samples to %s", output.c_str()));
 }
-
@@ -24,15 +24,35 @@
 
 #include <vector>
 #include <yarp/robottestingframework/TestCase.h>
-#include <yarp/os/SystemInfoSerializer.h>
+#include "HostMonitor.h"
 
 class HostInfo {
 public:
     std::string name;
     int maxCpuLoad;
+    int minFreeMemory;
 };
 
 
+/**
+* \ingroup icub-tests
+* Checks the load and the memory of a set of hosts, asking the yarprun running on them.
+*
+*  Accepts the following parameters:
+* | Parameter name | Type   | Units | Default Value | Required | Description | Notes |
+* |:--------------:|:------:|:-----:|:-------------:|:--------:|:-----------:|:-----:|
+* | name           | string | -     | "SystemStatus" | No      | The name of the test. | -     |
+* | hosts          | lists  | -     | -             | Yes      | The hosts as lists of <yarprun name> <max cpu load (%)> [<min free memory (MB)>]. | The cpu load is the load average of the last minute x 100. |
+* | time           | double | s     | 0             | No       | The duration of the monitoring: 0 takes a single sample of each host. | - |
+* | period         | double | s     | 1             | No       | The sampling period. | - |
+* | output         | string | -     | -             | No       | If given, the samples of all the hosts are written to this CSV file. | - |
+*
+* All the hosts are sampled at the same time by their own HostMonitor, so that an
+* unreachable host does not delay the others. The peaks of the cpu load and of the load
+* average and the lowest free memory are reported, with the time they occurred, together
+* with the series of the cpu load, to correlate them with the results of the other tests.
+* To monitor the hosts for a whole suite, see the SystemMonitor fixture.
+*/
 class SystemStatus : public yarp::robottestingframework::TestCase {
 public:
     SystemStatus();
@@ -44,12 +64,12 @@ public:
 
     virtual void run();
 
-private:
-    bool getSystemInfo(std::string remote,
-                       yarp::os::SystemInfoSerializer& info);
 private:
     std::vector<HostInfo> hosts;
+    std::vector<HostMonitor*> monitors;
+    double time;
+    double period;
+    std::string output;
 };
 
 #endif //_SYSTEM_STATUS
-
@@ -83,6 +83,7 @@ bool TorqueControlAccuracy::setup(yarp::os::Property& property) {
 
     m_sampleTime = property.find("sampleTime").asFloat64();
     ROBOTTESTINGFRAMEWORK_ASSERT_ERROR_IF(m_sampleTime>0, "invalid sampleTime");
+    m_scheduler.setPeriod(m_sampleTime);
 
     Property options;
     options.put("device", "remote_controlboard");
@@ -205,6 +206,7 @@ void TorqueControlAccuracy::run()
             yarp::os::Bottle      dataToPlotRaw;
             yarp::os::Bottle      dataToPlotSync;
 
+            m_scheduler.start();
             while (1)
             {
                 double curr_time = yarp::os::Time::now();
@@ -233,9 +235,11 @@ void TorqueControlAccuracy::run()
                 b1.addFloat64(elapsed);
                 b1.addFloat64(m_torques[m_jointsList[i]]);
                 b1.addFloat64(m_cmd_single);
-                yarp::os::Time::delay(m_sampleTime);
+                m_scheduler.waitNext();
             }
 
+            ROBOTTESTINGFRAMEWORK_TEST_REPORT(m_scheduler.report());
+
             //reorder data
             for (int t = 0; t < dataToPlotRaw.size(); t++)
             {
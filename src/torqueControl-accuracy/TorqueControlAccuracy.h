@@ -25,6 +25,7 @@
 #include <yarp/robottestingframework/TestCase.h>
 #include <yarp/dev/ControlBoardInterfaces.h>
 #include <yarp/dev/PolyDriver.h>
+#include "FixedRateScheduler.h"
 
 /**
 * \ingroup icub-tests
@@ -71,6 +72,7 @@ private:
     int*        m_jointsList;
     int         m_cycles;
     double      m_sampleTime;
+    FixedRateScheduler m_scheduler;
     double*     m_zeros;
     double      m_step;
     int         m_n_part_joints;
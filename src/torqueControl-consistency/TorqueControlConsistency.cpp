@@ -114,6 +114,8 @@ bool TorqueControlConsistency::setup(yarp::os::Property& property) {
     prevcurr_tot=new double[n_part_joints];
     prevcurr_some=new double[n_cmd_joints];
     for (int i=0; i <n_cmd_joints; i++) jointsList[i]=jointsBottle->get(i).asInt32();
+    ROBOTTESTINGFRAMEWORK_ASSERT_ERROR_IF_FALSE(controlBoard.configure(dd, std::vector<int>(jointsList, jointsList+n_cmd_joints)),
+                                                controlBoard.getError());
 
     return true;
 }
@@ -126,38 +128,15 @@ void TorqueControlConsistency::tearDown()
 
 void TorqueControlConsistency::setMode(int desired_control_mode, yarp::dev::InteractionModeEnum desired_interaction_mode)
 {
-    for (int i=0; i<n_cmd_joints; i++)
-    {
-        icmd->setControlMode(jointsList[i],desired_control_mode);
-        iimd->setInteractionMode(jointsList[i],desired_interaction_mode);
-        yarp::os::Time::delay(0.010);
-    }
+    if (!controlBoard.setModes(desired_control_mode,desired_interaction_mode))
+        ROBOTTESTINGFRAMEWORK_TEST_REPORT("Unable to set control mode/interaction mode: "+controlBoard.getError());
 }
 
 void TorqueControlConsistency::verifyMode(int desired_control_mode, yarp::dev::InteractionModeEnum desired_interaction_mode, std::string title)
 {
-    int cmode;
-    yarp::dev::InteractionModeEnum imode;
-    int timeout = 0;
-
-    while (1)
+    if (!controlBoard.verifyModes(desired_control_mode,desired_interaction_mode))
     {
-        int ok=0;
-        for (int i=0; i<n_cmd_joints; i++)
-        {
-            icmd->getControlMode (jointsList[i],&cmode);
-            iimd->getInteractionMode(jointsList[i],&imode);
-            if (cmode==desired_control_mode && imode==desired_interaction_mode) ok++;
-        }
-        if (ok==n_cmd_joints) break;
-        if (timeout>100)
-        {
-            char sbuf[500];
-            sprintf(sbuf,"Test (%s) failed: current mode is (%d,%d), it should be (%d,%d)",title.c_str(), desired_control_mode,desired_interaction_mode,cmode,imode);
-            ROBOTTESTINGFRAMEWORK_ASSERT_ERROR(sbuf);
-        }
-        yarp::os::Time::delay(0.2);
-        timeout++;
+        ROBOTTESTINGFRAMEWORK_ASSERT_ERROR(Asserter::format("Test (%s) failed: %s",title.c_str(),controlBoard.getError().c_str()));
     }
     char sbuf[500];
     sprintf(sbuf,"Test (%s) passed: current mode is (%d,%d)",title.c_str(), desired_control_mode,desired_interaction_mode);
@@ -166,29 +145,8 @@ void TorqueControlConsistency::verifyMode(int desired_control_mode, yarp::dev::I
 
 void TorqueControlConsistency::goHome()
 {
-    for (int i=0; i<n_cmd_joints; i++)
-    {
-        ipos->setRefSpeed(jointsList[i],20.0);
-        ipos->positionMove(jointsList[i],zero);
-    }
-
-    int timeout = 0;
-    while (1)
-    {
-        int in_position=0;
-        for (int i=0; i<n_cmd_joints; i++)
-        {
-            ienc->getEncoder(jointsList[i],&pos_tot[jointsList[i]]);
-            if (fabs(pos_tot[jointsList[i]]-zero)<0.5) in_position++;
-        }
-        if (in_position==n_cmd_joints) break;
-        if (timeout>100)
-        {
-            ROBOTTESTINGFRAMEWORK_ASSERT_ERROR("Timeout while reaching zero position");
-        }
-        yarp::os::Time::delay(0.2);
-        timeout++;
-    }
+    ROBOTTESTINGFRAMEWORK_ASSERT_ERROR_IF_FALSE(controlBoard.goHome(std::vector<double>(n_cmd_joints, zero), 20.0, 0.5),
+                                                "Timeout while reaching zero position");
 }
 
 void TorqueControlConsistency::setRefTorque(double value)
@@ -25,6 +25,7 @@
 #include <yarp/robottestingframework/TestCase.h>
 #include <yarp/dev/ControlBoardInterfaces.h>
 #include <yarp/dev/PolyDriver.h>
+#include "ControlBoardHelper.h"
 
 class TorqueControlConsistency : public yarp::robottestingframework::TestCase {
 public:
@@ -69,6 +70,7 @@ private:
     yarp::dev::IControlMode     *icmd;
     yarp::dev::IInteractionMode  *iimd;
     yarp::dev::IEncoders         *ienc;
+    ControlBoardHelper           controlBoard;
     yarp::dev::ITorqueControl    *itrq;
 
     double  cmd_single;
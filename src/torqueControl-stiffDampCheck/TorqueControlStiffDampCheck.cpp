@@ -151,6 +151,8 @@ bool TorqueControlStiffDampCheck::setup(yarp::os::Property& property) {
     for (int i=0; i <n_cmd_joints; i++) stiffness[i]=b_stiff->get(i).asFloat64();
     for (int i=0; i <n_cmd_joints; i++) damping[i]=b_dump->get(i).asFloat64();
     for (int i=0; i <n_cmd_joints; i++) home[i]=b_home->get(i).asFloat64();
+    ROBOTTESTINGFRAMEWORK_ASSERT_ERROR_IF_FALSE(controlBoard.configure(dd, std::vector<int>(jointsList, jointsList+n_cmd_joints)),
+                                                controlBoard.getError());
     return true;
 }
 
@@ -164,42 +166,15 @@ void TorqueControlStiffDampCheck::tearDown()
 
 void TorqueControlStiffDampCheck::setMode(int desired_control_mode, yarp::dev::InteractionModeEnum desired_interaction_mode)
 {
-    for (int i=0; i<n_cmd_joints; i++)
-    {
-        icmd->setControlMode(jointsList[i],desired_control_mode);
-        iimd->setInteractionMode(jointsList[i],desired_interaction_mode);
-        yarp::os::Time::delay(0.010);
-    }
+    ROBOTTESTINGFRAMEWORK_ASSERT_ERROR_IF_FALSE(controlBoard.setModes(desired_control_mode,desired_interaction_mode),
+                                                "Unable to set control mode/interaction mode: "+controlBoard.getError());
 }
 
 void TorqueControlStiffDampCheck::verifyMode(int desired_control_mode, yarp::dev::InteractionModeEnum desired_interaction_mode, std::string title)
 {
-    int cmode;
-    yarp::dev::InteractionModeEnum imode;
-    int timeout = 0;
-
-    while (1)
+    if (!controlBoard.verifyModes(desired_control_mode,desired_interaction_mode))
     {
-        int ok=0;
-        for (int i=0; i<n_cmd_joints; i++)
-        {
-            icmd->getControlMode (jointsList[i],&cmode);
-            iimd->getInteractionMode(jointsList[i],&imode);
-            if (cmode==desired_control_mode && imode==desired_interaction_mode) ok++;
-        }
-        if (ok==n_cmd_joints) break;
-        if (timeout>100)
-        {
-            char sbuf[800];
-            sprintf(sbuf,"Test (%s) failed: current mode is (%s,%s), it should be (%s,%s)",title.c_str(),
-                    Vocab32::decode((NetInt32)desired_control_mode).c_str(),
-                    Vocab32::decode((NetInt32)desired_interaction_mode).c_str(),
-                    Vocab32::decode((NetInt32)cmode).c_str(),
-                    Vocab32::decode((NetInt32)imode).c_str());
-            ROBOTTESTINGFRAMEWORK_ASSERT_ERROR(sbuf);
-        }
-        yarp::os::Time::delay(0.2);
-        timeout++;
+        ROBOTTESTINGFRAMEWORK_ASSERT_ERROR(Asserter::format("Test (%s) failed: %s",title.c_str(),controlBoard.getError().c_str()));
     }
     char sbuf[500];
     sprintf(sbuf,"Test (%s) passed: current mode is (%s,%s)",title.c_str(), Vocab32::decode((NetInt32)desired_control_mode).c_str(),
@@ -209,29 +184,8 @@ void TorqueControlStiffDampCheck::verifyMode(int desired_control_mode, yarp::dev
 
 void TorqueControlStiffDampCheck::goHome()
 {
-    for (int i=0; i<n_cmd_joints; i++)
-    {
-        ipos->setRefSpeed(jointsList[i],20.0);
-        ipos->positionMove(jointsList[i],home[i]);
-    }
-
-    int timeout = 0;
-    while (1)
-    {
-        int in_position=0;
-        for (int i=0; i<n_cmd_joints; i++)
-        {
-            ienc->getEncoder(jointsList[i],&pos_tot[i]);
-            if (fabs(pos_tot[i]-home[i])<0.8) in_position++;
-        }
-        if (in_position==n_cmd_joints) break;
-        if (timeout>100)
-        {
-            ROBOTTESTINGFRAMEWORK_ASSERT_ERROR("Timeout while reaching home[i] position");
-        }
-        yarp::os::Time::delay(0.2);
-        timeout++;
-    }
+    ROBOTTESTINGFRAMEWORK_ASSERT_ERROR_IF_FALSE(controlBoard.goHome(std::vector<double>(home, home+n_cmd_joints), 20.0, 0.8),
+                                                "Timeout while reaching home position");
 }
 
 bool TorqueControlStiffDampCheck::setAndCheckImpedance(int joint, double stiffness, double damping)
@@ -255,20 +209,13 @@ bool TorqueControlStiffDampCheck::setAndCheckImpedance(int joint, double stiffne
     return true;
 }
 
-void TorqueControlStiffDampCheck::saveToFile(std::string filename, yarp::os::Bottle &b)
+void TorqueControlStiffDampCheck::openTelemetry(std::string filename, std::string name)
 {
-    std::fstream fs;
-    fs.open (filename.c_str(), std::fstream::out);
-
-    for (int i=0; i<b.size(); i++)
-    {
-        std::string s = b.get(i).toString();
-        std::replace(s.begin(), s.end(), '(', ' ');
-        std::replace(s.begin(), s.end(), ')', ' ');
-        fs << s << endl;
-    }
-
-    fs.close();
+    std::vector<std::string> channels;
+    channels.push_back(name);
+    channels.push_back("trq");
+    channels.push_back("ref_trq");
+    ROBOTTESTINGFRAMEWORK_ASSERT_ERROR_IF_FALSE(recorder.open(filename, channels), recorder.getError());
 }
 
 
@@ -308,6 +255,12 @@ void TorqueControlStiffDampCheck::run()
         int unused = scanf("%c", &c);
         ROBOTTESTINGFRAMEWORK_TEST_REPORT(Asserter::format("startingto collact data of joint %d......", jointsList[i]));
 
+        string testfilename = "posVStrq_";
+        Bottle b;
+        b.addInt32(jointsList[i]);
+        string filename1 = testfilename + partName + "_j" + b.toString().c_str() + ".tlm";
+        openTelemetry(filename1, "pos");
+
         double start_time = yarp::os::Time::now();
         double curr_time = start_time;
         while(curr_time < start_time+testLen_sec)
@@ -317,20 +270,13 @@ void TorqueControlStiffDampCheck::run()
             itrq->getTorque(jointsList[i], &torque);
             itrq->getRefTorque(jointsList[i], &reftrq);
 
-            Bottle& row = b_pos_trq.addList();
-            row.addFloat64(curr_pos-home[i]);
-            row.addFloat64(torque- init_torque);
-            row.addFloat64(reftrq);
+            double row[3] = { curr_pos-home[i], torque- init_torque, reftrq };
+            recorder.append(row);
             yarp::os::Time::delay(0.01);
             curr_time = yarp::os::Time::now();
         }
 
-        string testfilename = "posVStrq_";
-        Bottle b;
-        b.addInt32(jointsList[i]);
-        string filename1 = testfilename + partName + "_j" + b.toString().c_str() + ".txt";
-        saveToFile(filename1,b_pos_trq);
-        b_pos_trq.clear();
+        ROBOTTESTINGFRAMEWORK_TEST_CHECK(recorder.close(), Asserter::format("Saving %s", filename1.c_str()));
 
 
         ROBOTTESTINGFRAMEWORK_TEST_REPORT(Asserter::format("....DONE on joint %d", jointsList[i]));
@@ -344,6 +290,10 @@ void TorqueControlStiffDampCheck::run()
 
         ROBOTTESTINGFRAMEWORK_TEST_REPORT(Asserter::format("startingto collact data of joint %d......", jointsList[i]));
 
+        testfilename = "velVStrq_";
+        filename1 = testfilename + partName + "_j" + b.toString().c_str() + ".tlm";
+        openTelemetry(filename1, "vel");
+
         start_time = yarp::os::Time::now();
         curr_time = start_time;
         while(curr_time < start_time+testLen_sec)
@@ -353,20 +303,13 @@ void TorqueControlStiffDampCheck::run()
             itrq->getTorque(jointsList[i], &torque);
             itrq->getRefTorque(jointsList[i], &reftrq);
 
-            Bottle& row = b_vel_trq.addList();
-            row.addFloat64(curr_vel);
-            row.addFloat64(torque- init_torque);
-            row.addFloat64(reftrq);
+            double row[3] = { curr_vel, torque- init_torque, reftrq };
+            recorder.append(row);
             yarp::os::Time::delay(0.01);
             curr_time = yarp::os::Time::now();
         }
 
-        testfilename = "velVStrq_";
-        Bottle b1;
-        b1.addInt32(jointsList[i]);
-        filename1 = testfilename + partName + "_j" + b1.toString().c_str() + ".txt";
-        saveToFile(filename1,b_vel_trq);
-        b_vel_trq.clear();
+        ROBOTTESTINGFRAMEWORK_TEST_CHECK(recorder.close(), Asserter::format("Saving %s", filename1.c_str()));
         ROBOTTESTINGFRAMEWORK_TEST_REPORT(Asserter::format("....DONE on joint %d", jointsList[i]));
 
     }//end for
@@ -25,6 +25,8 @@
 #include <yarp/robottestingframework/TestCase.h>
 #include <yarp/dev/ControlBoardInterfaces.h>
 #include <yarp/dev/PolyDriver.h>
+#include "ControlBoardHelper.h"
+#include "Telemetry.h"
 
 
 using namespace yarp::os;
@@ -44,7 +46,7 @@ public:
     void setMode(int desired_control_mode, yarp::dev::InteractionModeEnum desired_interaction_mode);
     void verifyMode(int desired_control_mode, yarp::dev::InteractionModeEnum desired_interaction_mode, std::string title);
     bool setAndCheckImpedance(int joint, double stiffness, double damping);
-    void saveToFile(std::string filename, yarp::os::Bottle &b);
+    void openTelemetry(std::string filename, std::string name);
     std::string getPath(const std::string& str);
 
 private:
@@ -58,8 +60,7 @@ private:
     double *home;
     double *pos_tot;
     double  testLen_sec;
-    Bottle b_pos_trq;
-    Bottle b_vel_trq;
+    TelemetryRecorder recorder;
     bool plot_enabled;
 
 
@@ -69,6 +70,7 @@ private:
     yarp::dev::IControlMode     *icmd;
     yarp::dev::IInteractionMode  *iimd;
     yarp::dev::IEncoders         *ienc;
+    ControlBoardHelper           controlBoard;
     yarp::dev::ITorqueControl    *itrq;
     yarp::dev::IImpedanceControl *iimp;
 
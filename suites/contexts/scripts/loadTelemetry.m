@@ -0,0 +1,62 @@
+% iCub Robot Unit Tests (Robot Testing Framework)
+%
+% Copyright (C) 2015-2019 Istituto Italiano di Tecnologia (IIT)
+%
+% This library is free software; you can redistribute it and/or
+% modify it under the terms of the GNU Lesser General Public
+% License as published by the Free Software Foundation; either
+% version 2.1 of the License, or (at your option) any later version.
+%
+% This library is distributed in the hope that it will be useful,
+% but WITHOUT ANY WARRANTY; without even the implied warranty of
+% MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+% Lesser General Public License for more details.
+%
+% You should have received a copy of the GNU Lesser General Public
+% License along with this library; if not, write to the Free Software
+% Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+
+# loads a telemetry file written by the tests: returns one column per
+# channel and the channel names. Text files are loaded with load().
+function [data, names] = loadTelemetry(filename)
+
+fid = fopen(filename, "r", "ieee-le");
+if(fid < 0)
+    error("cannot open %s", filename);
+endif
+
+names = {};
+magic = fread(fid, [1 8], "char=>char");
+if(!strcmp(magic, "ICUBTLM1"))
+    fclose(fid);
+    data = load(filename);
+    return;
+endif
+
+n = fread(fid, 1, "uint32");
+headerSize = 12;
+names = cell(1, n);
+for i= 1:1:n
+    len = fread(fid, 1, "uint32");
+    names{i} = fread(fid, [1 len], "char=>char");
+    headerSize += 4 + len;
+endfor
+fseek(fid, mod(-headerSize, 8), SEEK_CUR);
+
+blocks = {};
+while(true)
+    rows = fread(fid, 2, "uint32");
+    if(numel(rows) < 2)
+        break;
+    endif
+    values = fread(fid, rows(1)*n, "double");
+    if(numel(values) < rows(1)*n)
+        break; # incomplete last block
+    endif
+    blocks{end+1} = reshape(values, rows(1), n);
+endwhile
+fclose(fid);
+
+data = vertcat(zeros(0, n), blocks{:});
+
+endfunction
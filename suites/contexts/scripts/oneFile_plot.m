@@ -19,7 +19,7 @@
 #define functio to plot one file
 function oneFile_plot(filename, titleStr, numofjoint)
 
-data = load(filename);
+data = loadTelemetry(filename);
 for i= 1:1:numofjoint
     
     subplot(numofjoint, 1, i, "align");
@@ -18,7 +18,7 @@
 
 #define function to plot one file
 function torqueStiffDamp_plot(filename, linearfact)
-data = load(filename);
+data = loadTelemetry(filename);
 m=min(data(:,1));
 mx=max(data(:,1));
 
@@ -32,7 +32,7 @@ figure(1);
 for i= 1:1:numofjoint
     
     subplot(numofjoint, 1, i, "align");
-    filename = strcat("posVStrq_", partname, "_j",  num2str(jointlist(i)), ".txt");
+    filename = strcat("posVStrq_", partname, "_j",  num2str(jointlist(i)), ".tlm");
     printf("I'm going to plot file %s\n", filename);
     torqueStiffDamp_plot(filename, stiffness(i));
     refresh();
@@ -48,7 +48,7 @@ figure(2);
 for i= 1:1:numofjoint
     
     subplot(numofjoint, 1, i, "align");
-    filename = strcat("velVStrq_", partname, "_j",  num2str(jointlist(i)), ".txt");
+    filename = strcat("velVStrq_", partname, "_j",  num2str(jointlist(i)), ".tlm");
     printf("I'm going to plot file %s\n", filename);
     torqueStiffDamp_plot(filename, damping(i));
     refresh();
@@ -0,0 +1,92 @@
+/*
+ * iCub Robot Unit Tests (Robot Testing Framework)
+ *
+ * Copyright (C) 2015-2019 Istituto Italiano di Tecnologia (IIT)
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+#include <cstdio>
+#include "SequenceAnalyzer.h"
+
+static int failures = 0;
+
+#define CHECK_EQUAL(value, expected) \
+    if((unsigned long)(value) != (unsigned long)(expected)) { \
+        printf("%s:%d: %s is %lu, expected %lu\n", __FILE__, __LINE__, #value, \
+               (unsigned long)(value), (unsigned long)(expected)); \
+        failures++; \
+    }
+
+// a single message far behind the highest one is not a restart
+static void testStaleMessage() {
+    SequenceAnalyzer seq;
+    for(int i=0; i<=100; i++)
+        if(i != 20)
+            seq.add(i);
+    seq.add(20);
+    for(int i=101; i<=110; i++)
+        seq.add(i);
+    CHECK_EQUAL(seq.getLost(), 1);
+    CHECK_EQUAL(seq.getStale(), 1);
+    CHECK_EQUAL(seq.getRestarts(), 0);
+}
+
+// a message far behind the highest one followed by its successor is a restart
+static void testConfirmedRestart() {
+    SequenceAnalyzer seq;
+    for(int i=0; i<=1000; i++)
+        seq.add(i);
+    for(int i=500; i<=510; i++)
+        seq.add(i);
+    CHECK_EQUAL(seq.getLost(), 0);
+    CHECK_EQUAL(seq.getStale(), 0);
+    CHECK_EQUAL(seq.getRestarts(), 1);
+}
+
+// a sender restarted from 0
+static void testRestartFromZero() {
+    SequenceAnalyzer seq;
+    for(int i=0; i<=1000; i++)
+        seq.add(i);
+    seq.add(0);
+    seq.add(1);
+    seq.add(3);
+    CHECK_EQUAL(seq.getLost(), 1);
+    CHECK_EQUAL(seq.getStale(), 0);
+    CHECK_EQUAL(seq.getRestarts(), 1);
+}
+
+// a late message splits the burst it belonged to
+static void testLateMessage() {
+    SequenceAnalyzer seq;
+    seq.add(0);
+    seq.add(64);
+    seq.add(10);
+    CHECK_EQUAL(seq.getLost(), 62);
+    CHECK_EQUAL(seq.getReordered(), 1);
+    CHECK_EQUAL(seq.getBursts()[8], 1);
+    CHECK_EQUAL(seq.getBursts().back(), 1);
+}
+
+int main() {
+    testStaleMessage();
+    testConfirmedRestart();
+    testRestartFromZero();
+    testLateMessage();
+    if(failures == 0)
+        printf("All the checks passed\n");
+    return (failures == 0) ? 0 : 1;
+}